@@ -0,0 +1,65 @@
+#include "analysisPasses.h"
+
+#include "llvm/Support/CommandLine.h"
+
+#include "passPlugin.h"
+
+char TaintAnalysis::ID = 0;
+char VeryBusyAnalysis::ID = 0;
+
+static llvm::RegisterPass<TaintAnalysis> registerTaint("taint", "Taint analysis", false, true);
+static llvm::RegisterPass<VeryBusyAnalysis> registerVeryBusy("very-busy", "Very busy expressions", false, true);
+
+static llvm::cl::opt<bool> ReportTaint("report-taint", llvm::cl::desc("Print the taint analysis of every function"));
+static llvm::cl::opt<bool> ReportVeryBusy("report-very-busy", llvm::cl::desc("Print the very busy expressions of every function"));
+static RegisterPrinter<TaintAnalysis> printTaint(ReportTaint);
+static RegisterPrinter<VeryBusyAnalysis> printVeryBusy(ReportVeryBusy);
+
+bool TaintAnalysis::runOnFunction(llvm::Function &F) {
+    exits = taintFixpoint(F);
+    return false;
+}
+
+void TaintAnalysis::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+}
+
+void TaintAnalysis::releaseMemory() {
+    exits.clear();
+}
+
+void TaintAnalysis::print(llvm::raw_ostream &OS, const llvm::Module *) const {
+    printBBVars(exits, OS);
+}
+
+bool TaintAnalysis::isTainted(const llvm::BasicBlock *BB, const llvm::Value *var) const {
+    // the sets hold the allocas
+    auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(var);
+    auto it = exits.find(getSimpleNodeLabel(BB));
+    return alloca && it != exits.end() && it->second.count(const_cast<llvm::AllocaInst *>(alloca));
+}
+
+bool VeryBusyAnalysis::runOnFunction(llvm::Function &F) {
+    exprs = std::make_unique<ExprUniverse>(F);
+    blocks = veryBusyFixpoint(F, *exprs);
+    return false;
+}
+
+void VeryBusyAnalysis::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+}
+
+void VeryBusyAnalysis::releaseMemory() {
+    blocks = BlockVBMap();
+    exprs.reset();
+}
+
+void VeryBusyAnalysis::print(llvm::raw_ostream &OS, const llvm::Module *) const {
+    if (exprs)
+        printVB(*exprs, blocks, OS);
+}
+
+const std::pair<BitVec, BitVec> *VeryBusyAnalysis::busy(const llvm::BasicBlock *BB) const {
+    auto it = blocks.busy.find(BB);
+    return it == blocks.busy.end() ? nullptr : &it->second;
+}
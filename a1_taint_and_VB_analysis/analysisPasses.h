@@ -0,0 +1,67 @@
+#ifndef A1_ANALYSISPASSES_H
+#define A1_ANALYSISPASSES_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "llvm/IR/Function.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "bitvec.h"
+#include "utils.h"
+#include "veryBusy.h"
+
+/*
+ * The taint (task 4) and very busy expression (task 5) analyses as analysis passes, built by `compile_plugin`
+ * into libA1Analyses.so to run inside `opt` or clang on the module in memory, without writing a .ll file and
+ * parsing it again:
+ *     opt-7 -load ./libA1Analyses.so -analyze -taint tests/task4_1.ll
+ *     clang-7 -fno-discard-value-names -Xclang -load -Xclang ./libA1Analyses.so -mllvm -report-very-busy -c tests/task5_1.c
+ * The pass manager keeps the results of a function until a pass that does not preserve them runs, so a later
+ * pass asks for them with getAnalysis<TaintAnalysis>() without computing them again.
+ */
+class TaintAnalysis : public llvm::FunctionPass {
+public:
+    static char ID;
+    TaintAnalysis(): FunctionPass(ID) {}
+
+    bool runOnFunction(llvm::Function &F) override;
+    void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+    void releaseMemory() override;
+    // as printed by task4
+    void print(llvm::raw_ostream &OS, const llvm::Module *M) const override;
+
+    // tainted variables at the exit of every reachable block, by label
+    [[nodiscard]] const std::map<std::string, instr_set> &exitVars() const { return exits; }
+    // whether the variable `var` (its alloca) is tainted at the exit of `BB`
+    [[nodiscard]] bool isTainted(const llvm::BasicBlock *BB, const llvm::Value *var) const;
+
+private:
+    std::map<std::string, instr_set> exits;
+};
+
+class VeryBusyAnalysis : public llvm::FunctionPass {
+public:
+    static char ID;
+    VeryBusyAnalysis(): FunctionPass(ID) {}
+
+    bool runOnFunction(llvm::Function &F) override;
+    void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+    void releaseMemory() override;
+    // as printed by task5
+    void print(llvm::raw_ostream &OS, const llvm::Module *M) const override;
+
+    // the expressions of the function, numbered as in the bit vectors
+    [[nodiscard]] const ExprUniverse &universe() const { return *exprs; }
+    // the expressions very busy at the entry (first) and exit (second) of `BB`, nullptr if it is not reached
+    [[nodiscard]] const std::pair<BitVec, BitVec> *busy(const llvm::BasicBlock *BB) const;
+
+private:
+    std::unique_ptr<ExprUniverse> exprs;
+    BlockVBMap blocks;
+};
+
+#endif //A1_ANALYSISPASSES_H
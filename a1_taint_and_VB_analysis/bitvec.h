@@ -0,0 +1,144 @@
+#ifndef A1_BITVEC_H
+#define A1_BITVEC_H
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+ * Fixed size dense bit vector used as an analysis state, bit i stands for the i-th variable
+ * (or expression) of the function. All the lattice operations work a 64 bit word at a time,
+ * and four words at a time when compiled with AVX2.
+ */
+class BitVec {
+public:
+    typedef uint64_t word_t;
+    static const unsigned WORD_BITS = 64;
+
+    BitVec() = default;
+    explicit BitVec(unsigned size) : bits(size), words((size + WORD_BITS - 1) / WORD_BITS, 0) {}
+
+    [[nodiscard]] unsigned size() const { return bits; }
+
+    [[nodiscard]] bool test(unsigned i) const { return (words[i / WORD_BITS] >> (i % WORD_BITS)) & 1; }
+    void set(unsigned i) { words[i / WORD_BITS] |= word_t(1) << (i % WORD_BITS); }
+    void reset(unsigned i) { words[i / WORD_BITS] &= ~(word_t(1) << (i % WORD_BITS)); }
+
+    [[nodiscard]] bool any() const {
+        for (word_t w: words)
+            if (w)
+                return true;
+        return false;
+    }
+
+    [[nodiscard]] unsigned count() const {
+        unsigned n = 0;
+        for (word_t w: words)
+            n += __builtin_popcountll(w);
+        return n;
+    }
+
+    // this |= other, return whether a bit was added
+    bool unionWith(const BitVec &other) {
+        word_t *a = words.data();
+        const word_t *b = other.words.data();
+        size_t n = words.size(), i = 0;
+        word_t added = 0;
+#ifdef __AVX2__
+        __m256i addedVec = _mm256_setzero_si256();
+        for (; i + 4 <= n; i += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            addedVec = _mm256_or_si256(addedVec, _mm256_andnot_si256(x, y));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(a + i), _mm256_or_si256(x, y));
+        }
+        added = !_mm256_testz_si256(addedVec, addedVec);
+#endif
+        for (; i < n; ++i) {
+            added |= b[i] & ~a[i];
+            a[i] |= b[i];
+        }
+        return added != 0;
+    }
+
+    // this &= other, return whether a bit was removed
+    bool intersectWith(const BitVec &other) {
+        word_t *a = words.data();
+        const word_t *b = other.words.data();
+        size_t n = words.size(), i = 0;
+        word_t removed = 0;
+#ifdef __AVX2__
+        __m256i removedVec = _mm256_setzero_si256();
+        for (; i + 4 <= n; i += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            removedVec = _mm256_or_si256(removedVec, _mm256_andnot_si256(y, x));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(a + i), _mm256_and_si256(x, y));
+        }
+        removed = !_mm256_testz_si256(removedVec, removedVec);
+#endif
+        for (; i < n; ++i) {
+            removed |= a[i] & ~b[i];
+            a[i] &= b[i];
+        }
+        return removed != 0;
+    }
+
+    // this &= ~other
+    void subtract(const BitVec &other) {
+        word_t *a = words.data();
+        const word_t *b = other.words.data();
+        size_t n = words.size(), i = 0;
+#ifdef __AVX2__
+        for (; i + 4 <= n; i += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(a + i), _mm256_andnot_si256(y, x));
+        }
+#endif
+        for (; i < n; ++i)
+            a[i] &= ~b[i];
+    }
+
+    // whether this & other is not empty
+    [[nodiscard]] bool intersects(const BitVec &other) const {
+        const word_t *a = words.data(), *b = other.words.data();
+        size_t n = words.size(), i = 0;
+#ifdef __AVX2__
+        for (; i + 4 <= n; i += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            if (!_mm256_testz_si256(x, y))
+                return true;
+        }
+#endif
+        for (; i < n; ++i)
+            if (a[i] & b[i])
+                return true;
+        return false;
+    }
+
+    // call fn(i) for every set bit i in increasing order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (size_t w = 0; w < words.size(); ++w)
+            for (word_t rest = words[w]; rest; rest &= rest - 1)
+                fn(unsigned(w * WORD_BITS + __builtin_ctzll(rest)));
+    }
+
+    bool operator==(const BitVec &other) const { return bits == other.bits && words == other.words; }
+    bool operator!=(const BitVec &other) const { return !(*this == other); }
+    // arbitrary total order, to use bit vectors as keys of ordered containers
+    bool operator<(const BitVec &other) const {
+        return bits != other.bits ? bits < other.bits : words < other.words;
+    }
+
+private:
+    unsigned bits = 0;
+    std::vector<word_t> words;
+};
+
+#endif //A1_BITVEC_H
@@ -0,0 +1,163 @@
+#include <chrono>
+#include <map>
+#include <stack>
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "cfgGen.h"
+#include "taintBits.h"
+#include "taintSparse.h"
+#include "utils.h"
+
+/*
+ * Compares the worklist engine used by task4 against the DFS driver it replaced,
+ * on generated functions with thousands of blocks, then the set and bit vector (--bitvector)
+ * taint states and the sparse def-use propagation (--sparse) on functions with more and more local variables,
+ * then the bit vector engine against the semi-naive propagation of new facts only (--delta) on functions
+ * made mostly of nested loops. `facts` counts the (block, variable) pairs added at block entries.
+ */
+
+struct BenchResult {
+    unsigned long long visits = 0;
+    double ms = 0;
+    double fixpointMs = 0; // without building the summaries and the result
+    std::map<std::string, instr_set> BBExitVars;
+};
+
+BenchResult runDfs(llvm::Function *F);
+BenchResult runWorklist(llvm::Function *F);
+BenchResult runBitVector(llvm::Function *F);
+BenchResult runSparse(llvm::Function *F);
+BenchResult runDelta(llvm::Function *F, unsigned long long &facts);
+
+
+int main() {
+    llvm::outs() << "statements  blocks  dfs visits  dfs ms  worklist visits  worklist ms  same result\n";
+    for (unsigned statements: {100, 200, 400, 800, 1600}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = statements;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        BenchResult dfs = runDfs(F);
+        BenchResult worklist = runWorklist(F);
+        llvm::outs() << llvm::format("%10u  %6u  %10llu  %6.1f  %15llu  %11.1f  %s\n", statements, F->size(),
+                                     dfs.visits, dfs.ms, worklist.visits, worklist.ms,
+                                     dfs.BBExitVars == worklist.BBExitVars ? "yes" : "no");
+    }
+
+    llvm::outs() << "\n  vars  blocks  set ms  bitvector ms  sparse ms  sparse visits  same result\n";
+    for (unsigned vars: {16, 64, 256, 1024}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 800;
+        shape.vars = vars;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        BenchResult set = runWorklist(F);
+        BenchResult bits = runBitVector(F);
+        BenchResult sparse = runSparse(F);
+        llvm::outs() << llvm::format("%6u  %6u  %6.1f  %12.1f  %9.1f  %13llu  %s\n", vars, F->size(), set.ms, bits.ms,
+                                     sparse.ms, sparse.visits,
+                                     set.BBExitVars == bits.BBExitVars && set.BBExitVars == sparse.BBExitVars ? "yes" : "no");
+    }
+
+    llvm::outs() << "\n  vars  blocks  bitvector visits  bitvector ms  fixpoint ms  delta visits  delta facts  delta ms"
+                    "  fixpoint ms  same result\n";
+    for (unsigned vars: {16, 64, 256, 1024}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 800;
+        shape.vars = vars;
+        shape.maxDepth = 4;
+        shape.loops = 3;
+        shape.sources = 8;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        unsigned long long facts = 0;
+        BenchResult bits = runBitVector(F);
+        BenchResult delta = runDelta(F, facts);
+        llvm::outs() << llvm::format("%6u  %6u  %16llu  %12.1f  %11.1f  %12llu  %11llu  %8.1f  %11.1f  %s\n", vars,
+                                     F->size(), bits.visits, bits.ms, bits.fixpointMs, delta.visits, facts, delta.ms,
+                                     delta.fixpointMs, bits.BBExitVars == delta.BBExitVars ? "yes" : "no");
+    }
+    return 0;
+}
+
+BenchResult runDfs(llvm::Function *F) {
+    // the driver task4 used before the worklist engine
+    BenchResult res;
+    auto start = std::chrono::steady_clock::now();
+    std::stack<std::pair<llvm::BasicBlock*, instr_set>> dfsStack;
+    dfsStack.emplace(&F->getEntryBlock(), instr_set());
+    while (!dfsStack.empty()) {
+        auto [BB, taintedVars] = dfsStack.top();
+        dfsStack.pop();
+        ++res.visits;
+
+        updateTaintedVars(BB, taintedVars);
+
+        std::string blockName = getSimpleNodeLabel(BB);
+        auto oldExitVars = res.BBExitVars[blockName];
+        auto &exitVars = res.BBExitVars[blockName];
+        std::copy(taintedVars.cbegin(), taintedVars.cend(), std::inserter(exitVars, exitVars.begin()));
+
+        for (auto suc: llvm::successors(BB))
+            if (oldExitVars != exitVars || res.BBExitVars.count(getSimpleNodeLabel(suc)) == 0)
+                dfsStack.emplace(suc, exitVars);
+    }
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return res;
+}
+
+BenchResult runWorklist(llvm::Function *F) {
+    BenchResult res;
+    FixpointStats stats;
+    auto start = std::chrono::steady_clock::now();
+    res.BBExitVars = taintFixpoint(*F, &stats);
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.visits = stats.visits;
+    return res;
+}
+
+BenchResult runBitVector(llvm::Function *F) {
+    BenchResult res;
+    FixpointStats stats;
+    auto start = std::chrono::steady_clock::now();
+    res.BBExitVars = taintBitsFixpoint(*F, &stats);
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.fixpointMs = 1000 * stats.seconds;
+    res.visits = stats.visits;
+    return res;
+}
+
+BenchResult runSparse(llvm::Function *F) {
+    BenchResult res;
+    auto start = std::chrono::steady_clock::now();
+    TaintSparse taint(*F);
+    res.BBExitVars = taint.exitVars();
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // tainted values and (variable, block) pairs
+    res.visits = taint.numVisited();
+    return res;
+}
+
+BenchResult runDelta(llvm::Function *F, unsigned long long &facts) {
+    BenchResult res;
+    FixpointStats stats;
+    auto start = std::chrono::steady_clock::now();
+    res.BBExitVars = taintDeltaFixpoint(*F, &stats);
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.fixpointMs = 1000 * stats.seconds;
+    res.visits = stats.visits;
+    facts = stats.joins;
+    return res;
+}
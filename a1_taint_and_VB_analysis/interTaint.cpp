@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <memory>
+
+#include "interTaint.h"
+#include "resultWriter.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/Analysis/CallGraph.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/Support/Error.h"
+
+InterTaint::InterTaint(llvm::Module &M) {
+    if (llvm::Error E = M.materializeAll())
+        llvm::logAllUnhandledErrors(std::move(E), llvm::errs(), "error: failed to materialize the module: ");
+
+    for (auto &G: M.globals()) {
+        globalIds[&G] = globals.size();
+        globals.push_back(&G);
+    }
+
+    // bottom-up: the SCCs come callees first
+    llvm::CallGraph CG(M);
+    std::vector<std::vector<llvm::Function *>> sccs;
+    for (auto it = llvm::scc_begin(&CG); !it.isAtEnd(); ++it) {
+        std::vector<llvm::Function *> scc;
+        bool recursive = it->size() > 1;
+        for (llvm::CallGraphNode *node: *it) {
+            llvm::Function *F = node->getFunction();
+            if (!F || F->isDeclaration())
+                continue;
+            scc.push_back(F);
+            for (auto &callee: *node)
+                recursive |= callee.second == node;
+        }
+        if (scc.empty())
+            continue;
+
+        for (auto *F: scc) {
+            // the empty summary, calls into the SCC see it until the first analysis is done
+            FunctionResult &result = results[F];
+            result.numParams = F->arg_size();
+            result.ret = BitVec(numInputs(*F));
+            result.globals.assign(globals.size(), BitVec(numInputs(*F)));
+        }
+        for (bool changed = true; changed; ) {
+            changed = false;
+            for (auto *F: scc) {
+                FunctionResult result = analyse(*F);
+                FunctionResult &old = results[F];
+                changed |= result.ret != old.ret || result.globals != old.globals;
+                old = std::move(result);
+            }
+            changed &= recursive;
+        }
+        sccs.push_back(std::move(scc));
+    }
+
+    // top-down: `source` is tainted in every function, callers then add the inputs they taint
+    for (auto &[F, result]: results) {
+        result.context = BitVec(numInputs(*F));
+        result.context.set(0);
+    }
+    for (auto scc = sccs.rbegin(); scc != sccs.rend(); ++scc) {
+        for (bool changed = true; changed; ) {
+            changed = false;
+            for (auto *F: *scc) {
+                const FunctionResult &caller = results.at(F);
+                for (const CallSite &call: caller.calls) {
+                    FunctionResult &callee = results.at(call.callee);
+                    for (unsigned i = 0; i < call.inputs.size(); ++i)
+                        if (!callee.context.test(i) && call.inputs[i].intersects(caller.context)) {
+                            callee.context.set(i);
+                            // callees in later SCCs are only visited once all their callers are done
+                            changed |= std::find(scc->begin(), scc->end(), call.callee) != scc->end();
+                        }
+                }
+            }
+        }
+    }
+}
+
+InterTaint::FunctionResult InterTaint::analyse(llvm::Function &F) const {
+    typedef std::vector<BitVec> state;
+    unsigned inputs = numInputs(F), numGlobals = globals.size();
+
+    FunctionResult result;
+    result.numParams = F.arg_size();
+    result.ret = BitVec(inputs);
+    result.globals.assign(numGlobals, BitVec(inputs));
+
+    std::unordered_map<const llvm::Value *, unsigned> allocaIds;
+    for (auto &BB: F)
+        for (auto &I: BB)
+            if (auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&I)) {
+                allocaIds[alloca] = numGlobals + result.vars.size();
+                result.vars.push_back(alloca);
+            }
+    auto location = [&](const llvm::Value *ptr) {
+        auto alloca = allocaIds.find(ptr);
+        if (alloca != allocaIds.end())
+            return int(alloca->second);
+        auto global = globalIds.find(ptr);
+        return global != globalIds.end() ? int(global->second) : -1;
+    };
+
+    // a register is defined once, so its dependencies are the union over all visits of its block
+    std::unordered_map<const llvm::Value *, BitVec> regs;
+    std::unordered_map<const llvm::Instruction *, unsigned> callIds;
+    auto valueDeps = [&](const llvm::Value *V) {
+        BitVec deps(inputs);
+        if (auto *arg = llvm::dyn_cast<llvm::Argument>(V))
+            deps.set(1 + arg->getArgNo());
+        else if (regs.count(V))
+            deps = regs.at(V);
+        return deps;
+    };
+    auto define = [&](const llvm::Value *V, const BitVec &deps) {
+        auto [it, isNew] = regs.emplace(V, deps);
+        if (!isNew)
+            it->second.unionWith(deps);
+    };
+
+    auto call = [&](const llvm::CallInst *call, state &deps) {
+        const llvm::Function *callee = call->getCalledFunction();
+        auto summary = callee ? results.find(callee) : results.end();
+        if (summary == results.end()) {
+            // no body to summarise, the result is as tainted as the arguments
+            BitVec ret(inputs);
+            for (auto &arg: call->arg_operands())
+                ret.unionWith(valueDeps(arg));
+            define(call, ret);
+            return;
+        }
+
+        // dependencies of the callee's inputs at this call
+        std::vector<BitVec> in(numInputs(*callee), BitVec(inputs));
+        in[0].set(0);
+        for (unsigned i = 0; i < callee->arg_size() && i < call->getNumArgOperands(); ++i)
+            in[1 + i] = valueDeps(call->getArgOperand(i));
+        for (unsigned g = 0; g < numGlobals; ++g)
+            in[1 + callee->arg_size() + g] = deps[g];
+
+        auto [id, isNew] = callIds.emplace(call, result.calls.size());
+        if (isNew)
+            result.calls.push_back({callee, in});
+        else
+            for (unsigned i = 0; i < in.size(); ++i)
+                result.calls[id->second].inputs[i].unionWith(in[i]);
+
+        auto translate = [&](const BitVec &calleeDeps) {
+            BitVec callerDeps(inputs);
+            calleeDeps.forEach([&](unsigned i) { callerDeps.unionWith(in[i]); });
+            return callerDeps;
+        };
+        define(call, translate(summary->second.ret));
+        for (unsigned g = 0; g < numGlobals; ++g)
+            deps[g] = translate(summary->second.globals[g]);
+    };
+
+    state init(numGlobals + result.vars.size(), BitVec(inputs));
+    for (unsigned g = 0; g < numGlobals; ++g)
+        init[g].set(1 + F.arg_size() + g);
+
+    Fixpoint<state> fixpoint(F, Direction::Forward);
+    fixpoint.run(init,
+                 [&](llvm::BasicBlock *BB, state &deps, const Fixpoint<state>::emit_fn &emit) {
+                     for (auto &I: *BB) {
+                         if (I.getName() == "source") {
+                             BitVec tainted(inputs);
+                             tainted.set(0);
+                             int loc = location(&I);
+                             if (loc >= 0)
+                                 deps[loc] = tainted;
+                             else
+                                 define(&I, tainted);
+                         } else if (auto *load = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+                             int loc = location(load->getPointerOperand());
+                             define(&I, loc >= 0 ? deps[loc] : valueDeps(load->getPointerOperand()));
+                         } else if (auto *store = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+                             int loc = location(store->getPointerOperand());
+                             if (loc < 0)
+                                 continue; // through a pointer
+                             BitVec value = valueDeps(store->getValueOperand());
+                             if (store->getPointerOperand()->getName() == "source")
+                                 // assuming `source` cannot be untainted
+                                 deps[loc].unionWith(value);
+                             else
+                                 deps[loc] = value;
+                         } else if (llvm::isa<llvm::BinaryOperator>(I) || llvm::isa<llvm::CastInst>(I) ||
+                                    llvm::isa<llvm::PHINode>(I)) {
+                             BitVec value(inputs);
+                             for (auto &op: I.operands())
+                                 value.unionWith(valueDeps(op));
+                             define(&I, value);
+                         } else if (auto *callInst = llvm::dyn_cast<llvm::CallInst>(&I)) {
+                             call(callInst, deps);
+                         } else if (auto *ret = llvm::dyn_cast<llvm::ReturnInst>(&I)) {
+                             if (ret->getReturnValue())
+                                 result.ret.unionWith(valueDeps(ret->getReturnValue()));
+                             for (unsigned g = 0; g < numGlobals; ++g)
+                                 result.globals[g].unionWith(deps[g]);
+                         }
+                     }
+                     for (auto suc: llvm::successors(BB))
+                         emit(suc, deps);
+                 },
+                 [](state &into, const state &incoming) {
+                     bool changed = false;
+                     for (unsigned i = 0; i < into.size(); ++i)
+                         changed |= into[i].unionWith(incoming[i]);
+                     return changed;
+                 });
+
+    for (auto BB: fixpoint.blocks())
+        if (fixpoint.reached(BB))
+            result.exits.emplace(BB, fixpoint.out(BB));
+    return result;
+}
+
+std::map<std::string, instr_set> InterTaint::exitVars(const llvm::Function &F) const {
+    const FunctionResult &result = results.at(&F);
+    std::map<std::string, instr_set> BBExitVars;
+    for (const auto &[BB, deps]: result.exits) {
+        instr_set &taintedVars = BBExitVars[getSimpleNodeLabel(BB)];
+        for (unsigned i = 0; i < result.vars.size(); ++i)
+            if (deps[globals.size() + i].intersects(result.context))
+                taintedVars.insert(result.vars[i]);
+    }
+    return BBExitVars;
+}
+
+std::string InterTaint::inputName(const llvm::Function &F, unsigned input) const {
+    if (input == 0)
+        return "source";
+    if (input <= F.arg_size()) {
+        const llvm::Argument *arg = F.arg_begin() + (input - 1);
+        return arg->hasName() ? arg->getName().str() : "%" + std::to_string(input - 1);
+    }
+    return "@" + globals[input - 1 - F.arg_size()]->getName().str();
+}
+
+void InterTaint::forEachOutput(const llvm::Function &F,
+                               const std::function<void(const std::string &, const BitVec &)> &fn) const {
+    const FunctionResult &result = results.at(&F);
+    if (!F.getReturnType()->isVoidTy())
+        fn("return", result.ret);
+    for (unsigned g = 0; g < globals.size(); ++g) {
+        const BitVec &deps = result.globals[g];
+        unsigned self = 1 + F.arg_size() + g;
+        // globals left as they were are not worth a line
+        if (deps.count() != 1 || !deps.test(self))
+            fn("@" + globals[g]->getName().str(), deps);
+    }
+}
+
+void InterTaint::printSummary(const llvm::Function &F, llvm::raw_ostream &OS) const {
+    forEachOutput(F, [&](const std::string &output, const BitVec &deps) {
+        OS << "summary: " << output << " <- {";
+        bool first = true;
+        deps.forEach([&](unsigned input) {
+            OS << (first ? "" : ", ") << inputName(F, input);
+            first = false;
+        });
+        OS << "}\n";
+    });
+}
+
+void InterTaint::writeSummary(const llvm::Function &F, ResultWriter &writer) const {
+    forEachOutput(F, [&](const std::string &output, const BitVec &deps) {
+        writer.record("summary", "output", output);
+        deps.forEach([&](unsigned input) { writer.record("input", "name", inputName(F, input)); });
+    });
+}
+
+function_analysis interTaintAnalysis(llvm::Module &M, bool printSummaries) {
+    // a function is printed with the taint of its callers and callees
+    CacheWholeModule = true;
+    auto taint = std::make_shared<const InterTaint>(M);
+    return [taint, printSummaries](llvm::Function &F, llvm::raw_ostream &OS) {
+        if (auto writer = resultWriter(OS)) {
+            if (printSummaries)
+                taint->writeSummary(F, *writer);
+            writeBBVars(taint->exitVars(F), *writer);
+            return;
+        }
+        if (printSummaries)
+            taint->printSummary(F, OS);
+        printBBVars(taint->exitVars(F), OS);
+    };
+}
@@ -0,0 +1,90 @@
+#ifndef A1_INTERTAINT_H
+#define A1_INTERTAINT_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "bitvec.h"
+#include "driver.h"
+#include "utils.h"
+
+/*
+ * Interprocedural taint analysis in two phases, IFDS style.
+ *
+ * Bottom-up over the SCCs of the call graph, every function is analysed once on symbolic inputs: bit 0
+ * stands for taint coming from a `source` variable, followed by one bit per parameter and one per global
+ * of the module. Each variable, register and global carries the inputs it depends on, and the function is
+ * summarised as the inputs its return value and every global at its exit depend on. A call applies the
+ * summary of the callee to the dependencies of the arguments and globals at the call site, so a callee is
+ * analysed once however many call sites it has. The summaries of a recursive SCC start empty and the SCC
+ * is analysed again until none of them changes.
+ *
+ * Top-down, the calling contexts (which inputs are actually tainted) start with only `source` tainted in
+ * every function, since a `source` variable is tainted wherever it is declared, and the tainted inputs of
+ * the callers flow into their callees. A variable is tainted at a block exit when its dependencies meet
+ * the context of its function.
+ *
+ * Within a function the rules are those of `updateTaintedVars`, and taint also flows through casts and phis.
+ * Stores through pointers are not tracked, and calls to functions without a body taint their result with
+ * their arguments.
+ */
+class InterTaint {
+public:
+    // the bodies of a lazily loaded module are all materialized
+    explicit InterTaint(llvm::Module &M);
+
+    // tainted variables at the exit of every reachable block of `F`, over all of its calling contexts
+    [[nodiscard]] std::map<std::string, instr_set> exitVars(const llvm::Function &F) const;
+
+    // the inputs the return value and the changed globals of `F` depend on, e.g. `summary: return <- {source, x}`
+    void printSummary(const llvm::Function &F, llvm::raw_ostream &OS) const;
+    // the same as a "summary" record per output followed by an "input" record per input it depends on
+    void writeSummary(const llvm::Function &F, ResultWriter &writer) const;
+
+private:
+    struct CallSite {
+        const llvm::Function *callee;
+        // dependencies of every input of the callee at the call, over the inputs of the caller
+        std::vector<BitVec> inputs;
+    };
+
+    struct FunctionResult {
+        unsigned numParams = 0;
+        // the summary
+        BitVec ret;
+        std::vector<BitVec> globals;
+        // the globals, then the allocas of the function
+        std::vector<llvm::AllocaInst *> vars;
+        std::map<const llvm::BasicBlock *, std::vector<BitVec>> exits;
+        std::vector<CallSite> calls;
+        // inputs tainted in some calling context
+        BitVec context;
+    };
+
+    std::vector<const llvm::GlobalVariable *> globals;
+    std::unordered_map<const llvm::Value *, unsigned> globalIds;
+    std::unordered_map<const llvm::Function *, FunctionResult> results;
+
+    [[nodiscard]] unsigned numInputs(const llvm::Function &F) const { return 1 + F.arg_size() + globals.size(); }
+    // analyse `F` with the current summaries of its callees
+    [[nodiscard]] FunctionResult analyse(llvm::Function &F) const;
+    [[nodiscard]] std::string inputName(const llvm::Function &F, unsigned input) const;
+    // calls `fn` with every output of the summary of `F` worth reporting and the inputs it depends on
+    void forEachOutput(const llvm::Function &F, const std::function<void(const std::string &, const BitVec &)> &fn) const;
+};
+
+// the --interprocedural analysis of the functions of `M`: the exit sets of every block, after the summary of the
+// function if `printSummaries`; sets CacheWholeModule since a function is printed with the taint of its callers
+// and callees
+function_analysis interTaintAnalysis(llvm::Module &M, bool printSummaries);
+
+#endif //A1_INTERTAINT_H
@@ -1,9 +1,14 @@
 #!/bin/bash
 rm tests/*.ll;
 rm tests/*.dot;
+rm -f tests/*.bc;
 for file in tests/*.c;
 do
   clang-7 -fno-discard-value-names -emit-llvm -S -o "${file/.c/.ll}" $file
+  # `./prepare.sh --bitcode` also emits bitcode, which the tools load lazily
+  if [ "$1" == "--bitcode" ]; then
+    clang-7 -fno-discard-value-names -emit-llvm -c -o "${file/.c/.bc}" $file
+  fi
 done
 
 for file in tests/*.ll;
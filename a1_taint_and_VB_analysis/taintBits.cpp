@@ -0,0 +1,234 @@
+#include "taintBits.h"
+#include <chrono>
+#include <deque>
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/CFG.h"
+
+namespace {
+// symbolic taint of a value: tainted for sure, or tainted if one of `deps` is tainted at block entry
+struct SymTaint {
+    bool tainted = false;
+    BitVec deps;
+
+    explicit SymTaint(unsigned numVars) : deps(numVars) {}
+
+    void joinWith(const SymTaint &other) {
+        tainted |= other.tainted;
+        deps.unionWith(other.deps);
+    }
+};
+}
+
+TaintBits::TaintBits(llvm::Function &F) {
+    for (auto &BB: F)
+        for (auto &I: BB)
+            if (auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&I)) {
+                varIds[alloca] = vars.size();
+                vars.push_back(alloca);
+            }
+
+    for (auto &BB: F)
+        summaries.emplace(&BB, summarise(BB));
+}
+
+TaintBits::BlockSummary TaintBits::summarise(const llvm::BasicBlock &BB) const {
+    unsigned n = numVars();
+    std::unordered_map<const llvm::Value *, SymTaint> regs;
+    std::map<unsigned, SymTaint> assigned;
+
+    auto varTaint = [&](unsigned id) {
+        auto it = assigned.find(id);
+        if (it != assigned.end())
+            return it->second;
+        SymTaint sym(n);
+        sym.deps.set(id);
+        return sym;
+    };
+    auto valueTaint = [&](const llvm::Value *V) {
+        auto it = regs.find(V);
+        return it != regs.end() ? it->second : SymTaint(n);
+    };
+
+    for (auto &I: BB) {
+        if (I.getName() == "source") {
+            SymTaint sym(n);
+            sym.tainted = true;
+            auto id = varIds.find(&I);
+            if (id != varIds.end())
+                assigned.insert_or_assign(id->second, sym);
+            else
+                regs.insert_or_assign(&I, sym);
+        } else if (auto *load = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+            auto id = varIds.find(load->getPointerOperand());
+            regs.insert_or_assign(&I, id != varIds.end() ? varTaint(id->second) : valueTaint(load->getPointerOperand()));
+        } else if (llvm::isa<llvm::BinaryOperator>(I)) {
+            SymTaint sym = valueTaint(I.getOperand(0));
+            sym.joinWith(valueTaint(I.getOperand(1)));
+            regs.insert_or_assign(&I, sym);
+        } else if (auto *store = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+            auto id = varIds.find(store->getPointerOperand());
+            if (id == varIds.end())
+                continue;
+            SymTaint sym = valueTaint(store->getValueOperand());
+            if (vars[id->second]->getName() == "source")
+                // assuming `source` cannot be untainted
+                sym.joinWith(varTaint(id->second));
+            assigned.insert_or_assign(id->second, sym);
+        }
+    }
+
+    BlockSummary summary{BitVec(n), BitVec(n), {}, {}};
+    for (auto &[id, sym]: assigned) {
+        if (sym.tainted) {
+            summary.kill.set(id);
+            summary.gen.set(id);
+        } else if (sym.deps.count() == 1 && sym.deps.test(id)) {
+            // only depends on its own entry taint, e.g. an untainted store into `source`
+            continue;
+        } else {
+            summary.kill.set(id);
+            if (sym.deps.any()) {
+                sym.deps.forEach([&](unsigned dep) { summary.copiedInto[dep].push_back(id); });
+                summary.copies.emplace_back(id, std::move(sym.deps));
+            }
+        }
+    }
+    return summary;
+}
+
+void TaintBits::transfer(const llvm::BasicBlock *BB, BitVec &tainted) const {
+    const BlockSummary &summary = summaries.at(BB);
+    // copies read the entry state, so test them before applying kill and gen
+    llvm::SmallVector<unsigned, 8> copied;
+    for (const auto &[id, deps]: summary.copies)
+        if (tainted.intersects(deps))
+            copied.push_back(id);
+
+    tainted.subtract(summary.kill);
+    tainted.unionWith(summary.gen);
+    for (unsigned id: copied)
+        tainted.set(id);
+}
+
+void TaintBits::transferFacts(const llvm::BasicBlock *BB, llvm::ArrayRef<unsigned> vars,
+                              llvm::SmallVectorImpl<unsigned> &tainted) const {
+    const BlockSummary &summary = summaries.at(BB);
+    for (unsigned var: vars) {
+        if (!summary.kill.test(var))
+            tainted.push_back(var);
+        if (summary.copiedInto.empty())
+            continue;
+        auto it = summary.copiedInto.find(var);
+        if (it != summary.copiedInto.end())
+            tainted.append(it->second.begin(), it->second.end());
+    }
+}
+
+instr_set TaintBits::toSet(const BitVec &tainted) const {
+    instr_set taintedVars;
+    tainted.forEach([&](unsigned id) { taintedVars.insert(vars[id]); });
+    return taintedVars;
+}
+
+std::map<std::string, instr_set> taintBitsFixpoint(llvm::Function &F, FixpointStats *stats) {
+    TaintBits taint(F);
+    Fixpoint<BitVec> fixpoint(F, Direction::Forward);
+    fixpoint.run(BitVec(taint.numVars()),
+                 [&taint](llvm::BasicBlock *BB, BitVec &tainted, const Fixpoint<BitVec>::emit_fn &emit) {
+                     taint.transfer(BB, tainted);
+                     for (auto suc: llvm::successors(BB))
+                         emit(suc, tainted);
+                 },
+                 [](BitVec &into, const BitVec &incoming) {
+                     return into.unionWith(incoming);
+                 });
+
+    if (stats)
+        *stats = fixpoint.stats();
+
+    std::map<std::string, instr_set> BBExitVars;
+    for (auto BB: fixpoint.blocks())
+        if (fixpoint.reached(BB))
+            BBExitVars[getSimpleNodeLabel(BB)] = taint.toSet(fixpoint.out(BB));
+    return BBExitVars;
+}
+
+std::map<std::string, instr_set> taintDeltaFixpoint(llvm::Function &F, FixpointStats *stats) {
+    TaintBits taint(F);
+    llvm::ReversePostOrderTraversal<llvm::Function *> RPOT(&F);
+    std::vector<llvm::BasicBlock *> order(RPOT.begin(), RPOT.end());
+    std::unordered_map<const llvm::BasicBlock *, unsigned> index;
+    for (unsigned i = 0; i < order.size(); ++i)
+        index[order[i]] = i;
+    std::vector<llvm::SmallVector<unsigned, 2>> successors(order.size());
+    for (unsigned i = 0; i < order.size(); ++i)
+        for (auto suc: llvm::successors(order[i]))
+            successors[i].push_back(index.at(suc));
+
+    auto start = std::chrono::steady_clock::now();
+    FixpointStats counts;
+    std::vector<BitVec> entries(order.size(), BitVec(taint.numVars())), exits(order.size(), BitVec(taint.numVars()));
+    // the variables tainted at the entry of each block since it was last processed
+    std::vector<std::vector<unsigned>> deltas(order.size());
+    // first in first out, unlike Fixpoint: the longer a block waits, the more new facts it takes in one visit
+    std::deque<unsigned> worklist;
+    std::vector<char> queued(order.size(), 0);
+
+    // hand the variables newly tainted at the exit of block `i` to its successors
+    auto propagate = [&](unsigned i, llvm::ArrayRef<unsigned> tainted) {
+        for (unsigned j: successors[i]) {
+            for (unsigned var: tainted) {
+                if (entries[j].test(var))
+                    continue;
+                entries[j].set(var);
+                deltas[j].push_back(var);
+                ++counts.joins;
+            }
+            if (!deltas[j].empty() && !queued[j]) {
+                queued[j] = 1;
+                worklist.push_back(j);
+                ++counts.pushes;
+            }
+        }
+    };
+
+    // the first visit of every block, on the empty entry state, only taints gen
+    llvm::SmallVector<unsigned, 16> tainted, reached;
+    for (unsigned i = 0; i < order.size(); ++i) {
+        ++counts.visits;
+        exits[i] = taint.gen(order[i]);
+        tainted.clear();
+        exits[i].forEach([&](unsigned var) { tainted.push_back(var); });
+        propagate(i, tainted);
+    }
+
+    std::vector<unsigned> delta;
+    while (!worklist.empty()) {
+        unsigned i = worklist.front();
+        worklist.pop_front();
+        queued[i] = 0;
+        ++counts.visits;
+        delta.swap(deltas[i]);
+        deltas[i].clear();
+
+        reached.clear();
+        taint.transferFacts(order[i], delta, reached);
+        tainted.clear();
+        for (unsigned var: reached)
+            if (!exits[i].test(var)) {
+                exits[i].set(var);
+                tainted.push_back(var);
+            }
+        propagate(i, tainted);
+    }
+    counts.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (stats)
+        *stats = counts;
+
+    std::map<std::string, instr_set> BBExitVars;
+    for (unsigned i = 0; i < order.size(); ++i)
+        BBExitVars[getSimpleNodeLabel(order[i])] = taint.toSet(exits[i]);
+    return BBExitVars;
+}
@@ -0,0 +1,72 @@
+#ifndef A1_TAINTBITS_H
+#define A1_TAINTBITS_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+
+#include "bitvec.h"
+#include "utils.h"
+
+/*
+ * Taint analysis on bit vectors. The allocas of a function are numbered once, and every block is
+ * summarised once by running it symbolically on an unknown entry state. A visit then only applies
+ *
+ *     exit = (entry & ~kill) | gen | {v : entry & copies(v) != {}}
+ *
+ * The copy entries are needed since `a = b + c` taints `a` exactly when `b` or `c` is tainted at the
+ * entry of the block, which a plain gen/kill pair cannot express.
+ *
+ * The transfer distributes over union: beyond `gen`, a variable is tainted at the exit because some variable
+ * is tainted at the entry. The summary therefore also maps every variable to the ones its taint at the entry
+ * reaches at the exit, which transferFacts() applies to the newly tainted variables only (see taintDeltaFixpoint).
+ */
+class TaintBits {
+public:
+    explicit TaintBits(llvm::Function &F);
+
+    [[nodiscard]] unsigned numVars() const { return vars.size(); }
+    [[nodiscard]] llvm::AllocaInst *var(unsigned id) const { return vars[id]; }
+
+    // apply the summary of `BB` to the tainted variables at its entry
+    void transfer(const llvm::BasicBlock *BB, BitVec &tainted) const;
+    // the variables tainted at the exit of `BB` when `vars` are at its entry, beyond gen: each of them unless the
+    // block kills it, and the variables copied from them, possibly more than once
+    void transferFacts(const llvm::BasicBlock *BB, llvm::ArrayRef<unsigned> vars, llvm::SmallVectorImpl<unsigned> &tainted) const;
+    // the variables tainted at the exit of `BB` whatever its entry
+    [[nodiscard]] const BitVec &gen(const llvm::BasicBlock *BB) const { return summaries.at(BB).gen; }
+
+    [[nodiscard]] instr_set toSet(const BitVec &tainted) const;
+
+private:
+    struct BlockSummary {
+        BitVec kill, gen;
+        // (variable, variables it is tainted by at the entry of the block)
+        std::vector<std::pair<unsigned, BitVec>> copies;
+        // the same the other way round: (variable, variables its taint at the entry is copied into)
+        std::unordered_map<unsigned, std::vector<unsigned>> copiedInto;
+    };
+
+    std::vector<llvm::AllocaInst *> vars;
+    std::unordered_map<const llvm::Value *, unsigned> varIds;
+    std::unordered_map<const llvm::BasicBlock *, BlockSummary> summaries;
+
+    BlockSummary summarise(const llvm::BasicBlock &BB) const;
+};
+
+// same result as taintFixpoint, computed on bit vectors
+std::map<std::string, instr_set> taintBitsFixpoint(llvm::Function &F, FixpointStats *stats = nullptr);
+// the same, semi-naively: a block is only passed the variables newly tainted at its entry and only hands on the
+// ones newly tainted at its exit, so the work is proportional to the (block, variable) facts found rather than
+// to the visits times the number of variables. `stats` counts a visit per block processing its new facts, and
+// a join per fact added at the entry of a block
+std::map<std::string, instr_set> taintDeltaFixpoint(llvm::Function &F, FixpointStats *stats = nullptr);
+
+#endif //A1_TAINTBITS_H
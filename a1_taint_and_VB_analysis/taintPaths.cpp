@@ -0,0 +1,171 @@
+#include <algorithm>
+
+#include "taintPaths.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/IR/CFG.h"
+
+namespace {
+uint64_t saturatingAdd(uint64_t a, uint64_t b) {
+    return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+}
+
+TaintPaths::TaintPaths(llvm::Function &F) : taintBits(F) {
+    std::vector<llvm::BasicBlock *> order;
+    std::unordered_map<const llvm::BasicBlock *, unsigned> index;
+    for (auto *BB: llvm::ReversePostOrderTraversal<llvm::Function *>(&F)) {
+        index[BB] = order.size();
+        order.push_back(BB);
+    }
+
+    // nodes of each block by their entry state, all predecessors of a block come first in reverse post-order
+    std::unordered_map<const llvm::BasicBlock *, std::map<BitVec, unsigned>> entryNodes;
+    entryNodes[order.front()].emplace(BitVec(taintBits.numVars()), 0);
+    nodes.push_back({order.front(), BitVec(), {}, {}, 1});
+
+    for (auto *BB: order) {
+        for (auto &[entry, n]: entryNodes[BB]) {
+            nodes[n].exit = entry;
+            taintBits.transfer(BB, nodes[n].exit);
+            for (auto *suc: llvm::successors(BB)) {
+                if (index[suc] <= index[BB])
+                    continue; // back edge
+                auto [it, isNew] = entryNodes[suc].emplace(nodes[n].exit, nodes.size());
+                if (isNew)
+                    nodes.push_back({suc, BitVec(), {}, {}, 0});
+                Node &sucNode = nodes[it->second];
+                if (!sucNode.preds.empty() && sucNode.preds.back() == n)
+                    continue; // several edges to the same block are a single path
+                sucNode.preds.push_back(n);
+                sucNode.predOffsets.push_back(sucNode.paths);
+                sucNode.paths = saturatingAdd(sucNode.paths, nodes[n].paths);
+            }
+        }
+
+        auto &varPaths = blockNodes[BB];
+        varPaths.resize(taintBits.numVars());
+        for (auto &entryNode: entryNodes[BB]) {
+            const Node &node = nodes[entryNode.second];
+            node.exit.forEach([&](unsigned var) {
+                VarPaths &paths = varPaths[var];
+                paths.nodes.push_back(entryNode.second);
+                paths.offsets.push_back(paths.total);
+                paths.total = saturatingAdd(paths.total, node.paths);
+            });
+        }
+    }
+}
+
+uint64_t TaintPaths::count(const llvm::BasicBlock *BB, unsigned var) const {
+    auto it = blockNodes.find(BB);
+    return it == blockNodes.end() ? 0 : it->second[var].total;
+}
+
+std::vector<const llvm::BasicBlock *> TaintPaths::decode(const llvm::BasicBlock *BB, unsigned var, uint64_t id) const {
+    const VarPaths &paths = blockNodes.at(BB)[var];
+    // the last node whose first path number is <= id
+    size_t i = std::upper_bound(paths.offsets.begin(), paths.offsets.end(), id) - paths.offsets.begin() - 1;
+    unsigned n = paths.nodes[i];
+    id -= paths.offsets[i];
+
+    std::vector<const llvm::BasicBlock *> blocks;
+    while (true) {
+        const Node &node = nodes[n];
+        blocks.push_back(node.BB);
+        if (node.preds.empty())
+            break;
+        size_t p = std::upper_bound(node.predOffsets.begin(), node.predOffsets.end(), id) - node.predOffsets.begin() - 1;
+        id -= node.predOffsets[p];
+        n = node.preds[p];
+    }
+    std::reverse(blocks.begin(), blocks.end());
+    return blocks;
+}
+
+TaintGraph::TaintGraph(llvm::Function &F) : taintBits(F) {
+    std::unordered_map<const llvm::BasicBlock *, std::map<BitVec, unsigned>> entryNodes;
+    const llvm::BasicBlock *entry = &F.getEntryBlock();
+    entryNodes[entry].emplace(BitVec(taintBits.numVars()), 0);
+    nodes.push_back({entry, BitVec(taintBits.numVars()), {}, 0});
+
+    // nodes are appended in breadth first order, so they are their own queue
+    for (unsigned n = 0; n < nodes.size(); ++n) {
+        taintBits.transfer(nodes[n].BB, nodes[n].exit);
+        for (auto *suc: llvm::successors(nodes[n].BB)) {
+            auto [it, isNew] = entryNodes[suc].emplace(nodes[n].exit, nodes.size());
+            if (isNew)
+                // the exit starts as the entry state, it is transferred when the node is dequeued
+                nodes.push_back({suc, nodes[n].exit, {}, nodes[n].dist + 1});
+            auto &preds = nodes[it->second].preds;
+            if (std::find(preds.begin(), preds.end(), n) == preds.end())
+                preds.push_back(n);
+        }
+    }
+}
+
+TaintPathEnumerator::TaintPathEnumerator(const TaintGraph &graph, const llvm::BasicBlock *BB, unsigned var, unsigned limit)
+        : graph(graph), limit(limit) {
+    const auto &nodes = graph.getNodes();
+    for (unsigned n = 0; n < nodes.size(); ++n)
+        if (nodes[n].BB == BB && nodes[n].exit.test(var))
+            push(n, nullptr);
+}
+
+void TaintPathEnumerator::push(unsigned node, const partial_ptr &rest) {
+    unsigned length = rest ? rest->length + 1 : 1;
+    auto partial = std::make_shared<const Partial>(Partial{node, length, rest});
+    queue.emplace(length - 1 + graph.getNodes()[node].dist, pushed++, std::move(partial));
+}
+
+bool TaintPathEnumerator::next(std::string &path) {
+    const auto &nodes = graph.getNodes();
+    while (yielded < limit && !queue.empty()) {
+        partial_ptr partial = std::get<2>(queue.top());
+        queue.pop();
+
+        if (nodes[partial->node].preds.empty()) {
+            // reached the entry node
+            path = render(partial.get());
+            if (seen.insert(path).second) {
+                ++yielded;
+                return true;
+            }
+            continue;
+        }
+        for (unsigned pred: nodes[partial->node].preds)
+            if (!contains(partial.get(), pred))
+                push(pred, partial);
+    }
+    return false;
+}
+
+bool TaintPathEnumerator::contains(const Partial *partial, unsigned node) {
+    for (; partial; partial = partial->rest.get())
+        if (partial->node == node)
+            return true;
+    return false;
+}
+
+std::string TaintPathEnumerator::render(const Partial *partial) const {
+    // (block, text) items, a loop is a single item without a block
+    std::vector<std::pair<const llvm::BasicBlock *, std::string>> items;
+    for (; partial; partial = partial->rest.get()) {
+        const llvm::BasicBlock *BB = graph.getNodes()[partial->node].BB;
+        auto again = std::find_if(items.rbegin(), items.rend(), [BB](const auto &item) { return item.first == BB; });
+        if (again != items.rend()) {
+            // the block was seen before, the blocks since then are a loop
+            auto start = again.base() - 1;
+            std::string loop = "(";
+            for (auto it = start; it != items.end(); ++it)
+                loop.append(it == start ? "" : "->").append(it->second);
+            items.erase(start, items.end());
+            items.emplace_back(nullptr, loop + ")*");
+        }
+        items.emplace_back(BB, getSimpleNodeLabel(BB));
+    }
+
+    std::string str;
+    for (const auto &item: items)
+        str.append(str.empty() ? "" : "->").append(item.second);
+    return str;
+}
@@ -0,0 +1,132 @@
+#ifndef A1_TAINTPATHS_H
+#define A1_TAINTPATHS_H
+
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/IR/Function.h"
+
+#include "bitvec.h"
+#include "taintBits.h"
+
+/*
+ * Taint paths of a loop free function, kept as a DAG of (block, tainted variables at its entry) nodes.
+ * Along one CFG path the tainted variables are known exactly, so every CFG path from the entry is a
+ * path through the DAG and paths are shared by prefix instead of being copied as strings.
+ *
+ * Paths into a node are numbered 0..count-1 in the style of Ball-Larus: the edges into a node are
+ * ordered, and the paths coming in through the i-th edge are numbered after those through the first
+ * i-1 edges, so a number is decoded back into blocks by walking the predecessors.
+ * Back edges are ignored, i.e. only paths without cycles are counted.
+ */
+class TaintPaths {
+public:
+    explicit TaintPaths(llvm::Function &F);
+
+    [[nodiscard]] const TaintBits &taint() const { return taintBits; }
+
+    // whether `BB` is reachable from the entry
+    [[nodiscard]] bool reached(const llvm::BasicBlock *BB) const { return blockNodes.count(BB) > 0; }
+
+    // number of paths from the entry to the exit of `BB` along which `var` is tainted,
+    // saturates at UINT64_MAX
+    [[nodiscard]] uint64_t count(const llvm::BasicBlock *BB, unsigned var) const;
+
+    // the `id`-th of those paths as a block sequence, for 0 <= id < count(BB, var)
+    [[nodiscard]] std::vector<const llvm::BasicBlock *> decode(const llvm::BasicBlock *BB, unsigned var, uint64_t id) const;
+
+private:
+    struct Node {
+        const llvm::BasicBlock *BB;
+        BitVec exit;                      // tainted variables at the exit of the block
+        std::vector<unsigned> preds;
+        std::vector<uint64_t> predOffsets; // number of the first path through each predecessor
+        uint64_t paths = 0;
+    };
+
+    // nodes of one block whose exit has the variable tainted, with the number of their first path
+    struct VarPaths {
+        std::vector<unsigned> nodes;
+        std::vector<uint64_t> offsets;
+        uint64_t total = 0;
+    };
+
+    TaintBits taintBits;
+    std::vector<Node> nodes;
+    std::unordered_map<const llvm::BasicBlock *, std::vector<VarPaths>> blockNodes;
+};
+
+/*
+ * The same (block, tainted variables at its entry) nodes over the whole CFG, back edges included,
+ * so the graph has cycles where the loops of the function are. There are finitely many nodes since
+ * there are finitely many tainted sets, so exploring from the entry until no new node shows up terminates.
+ */
+class TaintGraph {
+public:
+    struct Node {
+        const llvm::BasicBlock *BB;
+        BitVec exit;                 // tainted variables at the exit of the block
+        std::vector<unsigned> preds;
+        unsigned dist;               // length of the shortest path from the entry node
+    };
+
+    explicit TaintGraph(llvm::Function &F);
+
+    [[nodiscard]] const TaintBits &taint() const { return taintBits; }
+    [[nodiscard]] const std::vector<Node> &getNodes() const { return nodes; }
+
+private:
+    TaintBits taintBits;
+    std::vector<Node> nodes; // in breadth first order, the entry node first
+};
+
+/*
+ * Yields the paths from the entry to the exit of a block along which a variable is tainted one at a time,
+ * shortest first. The search runs backwards from the block over partial paths sharing their tails, ordered
+ * by their length plus the distance of their first node from the entry, so the first path is found after
+ * about as many steps as it is long.
+ *
+ * Only paths that do not go through the same graph node twice are followed, which makes the enumeration
+ * finite on loops. A block can still repeat with a different tainted set, the blocks from one occurrence
+ * to the next are then written as a loop, e.g. `entry->(while.cond->while.body)*->while.cond->while.end`.
+ * Paths that read the same once written that way are only yielded once.
+ */
+class TaintPathEnumerator {
+public:
+    TaintPathEnumerator(const TaintGraph &graph, const llvm::BasicBlock *BB, unsigned var, unsigned limit = UINT_MAX);
+
+    // store the next path in `path`, return false if there are no more paths or `limit` paths were yielded
+    bool next(std::string &path);
+
+private:
+    // a path from `node` to the block, sharing the rest of the path with other partial paths
+    struct Partial {
+        unsigned node;
+        unsigned length;
+        std::shared_ptr<const Partial> rest;
+    };
+    typedef std::shared_ptr<const Partial> partial_ptr;
+    // (estimated length of the whole path, insertion number, partial path)
+    typedef std::tuple<unsigned, unsigned long long, partial_ptr> queue_entry;
+
+    const TaintGraph &graph;
+    unsigned limit;
+    unsigned yielded = 0;
+    unsigned long long pushed = 0;
+    std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry>> queue;
+    std::set<std::string> seen;
+
+    void push(unsigned node, const partial_ptr &rest);
+    static bool contains(const Partial *partial, unsigned node);
+    [[nodiscard]] std::string render(const Partial *partial) const;
+};
+
+#endif //A1_TAINTPATHS_H
@@ -0,0 +1,147 @@
+#include "taintSparse.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/IR/CFG.h"
+
+TaintSparse::TaintSparse(llvm::Function &F) : F(F) {
+    for (auto &BB: F)
+        for (auto &I: BB)
+            if (auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&I)) {
+                varIds[alloca] = vars.size();
+                vars.push_back(alloca);
+            }
+    for (auto *BB: llvm::depth_first(&F)) {
+        blockIds[BB] = blocks.size();
+        blocks.push_back(BB);
+    }
+
+    entries.resize(vars.size());
+    exits.resize(vars.size());
+    propagate(index());
+}
+
+unsigned TaintSparse::valueNode(const llvm::Instruction *I) {
+    auto [it, isNew] = valueNodes.emplace(I, nodes.size());
+    if (isNew)
+        nodes.emplace_back();
+    return it->second;
+}
+
+std::vector<unsigned> TaintSparse::index() {
+    std::vector<unsigned> seeds;
+    for (unsigned block = 0; block < blocks.size(); ++block) {
+        auto define = [&](unsigned var, unsigned node) {
+            auto &varAccesses = accesses[key(var, block)];
+            nodes[node].var = var;
+            nodes[node].block = block;
+            nodes[node].index = varAccesses.size();
+            varAccesses.push_back(node);
+        };
+        auto use = [&](const llvm::Value *V, unsigned user) {
+            auto id = varIds.find(V);
+            if (id != varIds.end()) {
+                accesses[key(id->second, block)].push_back(user);
+            } else if (auto *I = llvm::dyn_cast<llvm::Instruction>(V)) {
+                // registers of other blocks are never tainted in the dense analysis
+                if (I->getParent() == blocks[block])
+                    nodes[valueNode(I)].users.push_back(user);
+            }
+        };
+
+        for (auto &I: *blocks[block]) {
+            if (I.getName() == "source") {
+                unsigned n = valueNode(&I);
+                auto id = varIds.find(&I);
+                if (id != varIds.end())
+                    define(id->second, n);
+                seeds.push_back(n);
+            } else if (auto *load = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+                use(load->getPointerOperand(), valueNode(load));
+            } else if (llvm::isa<llvm::BinaryOperator>(I)) {
+                unsigned n = valueNode(&I);
+                use(I.getOperand(0), n);
+                use(I.getOperand(1), n);
+            } else if (auto *store = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+                auto id = varIds.find(store->getPointerOperand());
+                // stores through pointers are not followed, and `source` stays tainted
+                if (id == varIds.end() || isSource(id->second))
+                    continue;
+                unsigned n = valueNode(store);
+                use(store->getValueOperand(), n);
+                define(id->second, n);
+            }
+        }
+    }
+    return seeds;
+}
+
+void TaintSparse::propagate(const std::vector<unsigned> &seeds) {
+    std::vector<unsigned> values;
+    std::vector<uint64_t> flows;
+    auto taint = [&](unsigned n) {
+        if (!nodes[n].tainted) {
+            nodes[n].tainted = true;
+            ++visited;
+            values.push_back(n);
+        }
+    };
+    // `var` is tainted in `block` from its `from`-th access on, until it is defined again
+    auto flow = [&](unsigned var, unsigned block, unsigned from) {
+        auto it = accesses.find(key(var, block));
+        if (it != accesses.end())
+            for (unsigned i = from; i < it->second.size(); ++i) {
+                unsigned n = it->second[i];
+                if (nodes[n].var == int(var))
+                    return;
+                taint(n);
+            }
+        if (exits[var].size() == 0) {
+            exits[var] = BitVec(blocks.size());
+            entries[var] = BitVec(blocks.size());
+        }
+        if (exits[var].test(block))
+            return; // the successors already have it
+        exits[var].set(block);
+        for (auto *suc: llvm::successors(blocks[block])) {
+            unsigned sucId = blockIds.at(suc);
+            if (!entries[var].test(sucId)) {
+                entries[var].set(sucId);
+                ++visited;
+                flows.push_back(key(var, sucId));
+            }
+        }
+    };
+
+    for (unsigned n: seeds)
+        taint(n);
+    while (!values.empty() || !flows.empty()) {
+        if (!flows.empty()) {
+            uint64_t entry = flows.back();
+            flows.pop_back();
+            flow(entry >> 32, entry & UINT32_MAX, 0);
+            continue;
+        }
+        unsigned n = values.back();
+        values.pop_back();
+        if (nodes[n].var >= 0)
+            // a definition: the rest of the block and whatever it reaches from there
+            flow(nodes[n].var, nodes[n].block, nodes[n].index + 1);
+        for (unsigned user: nodes[n].users)
+            taint(user);
+    }
+}
+
+std::map<std::string, instr_set> TaintSparse::exitVars() const {
+    std::vector<instr_set> exitSets(blocks.size());
+    for (unsigned var = 0; var < vars.size(); ++var)
+        if (exits[var].size())
+            exits[var].forEach([&](unsigned block) { exitSets[block].insert(vars[var]); });
+
+    std::map<std::string, instr_set> BBExitVars;
+    for (unsigned block = 0; block < blocks.size(); ++block)
+        BBExitVars[getSimpleNodeLabel(blocks[block])] = std::move(exitSets[block]);
+    return BBExitVars;
+}
+
+std::map<std::string, instr_set> taintSparse(llvm::Function &F) {
+    return TaintSparse(F).exitVars();
+}
@@ -0,0 +1,73 @@
+#ifndef A1_TAINTSPARSE_H
+#define A1_TAINTSPARSE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+
+#include "bitvec.h"
+#include "utils.h"
+
+/*
+ * Sparse taint analysis along def-use chains. Every store into a variable is a definition, every load a use,
+ * and registers link the loads of a block to the stores and operators using them. Reaching definitions are
+ * resolved on demand instead of by promoting the variables up front: a tainted definition flows through the
+ * later uses of its variable in its block and, unless the variable is defined again there, into the successors,
+ * where it keeps going until it meets a definition. Taint therefore only ever visits the tainted values and
+ * the (variable, block) pairs a tainted definition reaches, and the untainted variables cost one scan of the
+ * function.
+ *
+ * The exit sets are the same as those of `updateTaintedVars`: registers only carry taint within the block
+ * defining them, and stores into `source` do not untaint it.
+ */
+class TaintSparse {
+public:
+    explicit TaintSparse(llvm::Function &F);
+
+    // tainted variables at the exit of every reachable block
+    [[nodiscard]] std::map<std::string, instr_set> exitVars() const;
+    // tainted values and (variable, block) pairs visited
+    [[nodiscard]] unsigned long long numVisited() const { return visited; }
+
+private:
+    // a definition of a variable (a store, or the alloca of `source`), or a value: a load, a binary operator, `source`
+    struct Node {
+        int var = -1;
+        unsigned block = 0;
+        // position among the accesses of the variable in the block
+        unsigned index = 0;
+        std::vector<unsigned> users;
+        bool tainted = false;
+    };
+
+    llvm::Function &F;
+    std::vector<llvm::AllocaInst *> vars;
+    std::unordered_map<const llvm::Value *, unsigned> varIds;
+    // reachable blocks, in depth first order from the entry
+    std::vector<llvm::BasicBlock *> blocks;
+    std::unordered_map<const llvm::BasicBlock *, unsigned> blockIds;
+    std::vector<Node> nodes;
+    std::unordered_map<const llvm::Value *, unsigned> valueNodes;
+    // the loads and definitions of a variable in a block in program order, by key(var, block)
+    std::unordered_map<uint64_t, std::vector<unsigned>> accesses;
+    // blocks each variable is tainted at the entry and at the exit of, only allocated once the variable is tainted
+    std::vector<BitVec> entries, exits;
+    unsigned long long visited = 0;
+
+    static uint64_t key(unsigned var, unsigned block) { return uint64_t(var) << 32 | block; }
+    [[nodiscard]] bool isSource(unsigned var) const { return vars[var]->getName() == "source"; }
+    unsigned valueNode(const llvm::Instruction *I);
+    // build the def-use edges, returns the `source` nodes
+    std::vector<unsigned> index();
+    void propagate(const std::vector<unsigned> &seeds);
+};
+
+// same result as taintFixpoint, computed sparsely
+std::map<std::string, instr_set> taintSparse(llvm::Function &F);
+
+#endif //A1_TAINTSPARSE_H
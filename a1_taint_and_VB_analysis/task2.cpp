@@ -1,6 +1,7 @@
 #include <set>
 #include <map>
 #include <stack>
+#include <utility>
 
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
@@ -10,41 +11,62 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/Support/CommandLine.h"
 
-typedef std::set<llvm::Instruction*> instr_set;
+#include "driver.h"
+#include "hashCons.h"
+#include "interTaint.h"
+#include "taintBits.h"
+#include "taintSparse.h"
+#include "utils.h"
 
-std::string getSimpleNodeLabel(const llvm::BasicBlock *Node);
-void updateTaintedVars(llvm::BasicBlock* BB, instr_set &taintedVars);
-void printBBVars(const std::map<std::string, instr_set> &BBVars);
+static llvm::cl::opt<bool> BitVectorMode("bitvector", llvm::cl::desc("Keep tainted variables in bit vectors with per-block summaries"));
+static llvm::cl::opt<bool> SparseMode("sparse", llvm::cl::desc("Propagate taint along def-use edges instead of per-block sets"));
+static llvm::cl::opt<bool> Interprocedural("interprocedural", llvm::cl::desc("Follow taint through calls with a summary per function"));
+static llvm::cl::opt<bool> PrintSummaries("summaries", llvm::cl::desc("Print the interprocedural summary of every function"));
 
+std::map<std::string, instr_set> taintDfs(llvm::Function &F);
 
-int main(int argc, char **argv) {
-
-    // Extract Module M from IR (assuming only one Module exists)
-    // Modules are the top level container of all other LLVM Intermediate Representation (IR) objects.
-    // Read the IR file.
-    llvm::SMDiagnostic Err;
-    llvm::LLVMContext Context;  //A reference to the core LLVM "engine" that you should pass to the various methods that require a LLVMContext.
-    std::unique_ptr<llvm::Module> Mod(parseIRFile(argv[1], Err, Context));
-    if (!Mod) {
-        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
-        return EXIT_FAILURE;
-    }
 
-    // Extract Function main from Module M
-    llvm::Function *F = Mod->getFunction("main");
+int main(int argc, char **argv) {
+    return runDriver(argc, argv, "taint analysis\n", [](llvm::Module &M) -> function_analysis {
+        if (Interprocedural)
+            return interTaintAnalysis(M, PrintSummaries);
+        return [](llvm::Function &F, llvm::raw_ostream &OS) {
+            // without loops the fixpoint gives the same exit sets as the DFS
+            std::map<std::string, instr_set> BBExitVars = SparseMode ? taintSparse(F)
+                                                          : BitVectorMode ? taintBitsFixpoint(F) : taintDfs(F);
+            if (auto writer = resultWriter(OS))
+                writeBBVars(BBExitVars, *writer);
+            else
+                printBBVars(BBExitVars, OS);
+        };
+    });
+}
 
+std::map<std::string, instr_set> taintDfs(llvm::Function &F) {
     // define an exit map recording tainted variables at exits of blocks
     std::map<std::string, instr_set> BBExitVars;
 
+    // the states pushed are interned, and a (block, state) pair pushed before is dropped: a block only pushes
+    // the union of the states it has seen, which the earlier push of the pair already did
+    HashCons<instr_set> states;
+    std::set<std::pair<llvm::BasicBlock*, const instr_set*>> pushed;
+
     // stack for DFS
-    std::stack<std::pair<llvm::BasicBlock*, instr_set>> dfsStack;
+    std::stack<std::pair<llvm::BasicBlock*, const instr_set*>> dfsStack;
+    auto push = [&](llvm::BasicBlock *BB, const instr_set &vars) {
+        const instr_set *state = states.intern(vars);
+        if (pushed.emplace(BB, state).second)
+            dfsStack.emplace(BB, state);
+    };
 
     // initialise dfs with entry block
-    dfsStack.emplace(&F->getEntryBlock(), instr_set());
+    push(&F.getEntryBlock(), instr_set());
     while (!dfsStack.empty()) {
-        auto [BB, taintedVars] = dfsStack.top();
+        auto [BB, state] = dfsStack.top();
         dfsStack.pop();
+        instr_set taintedVars = *state;
 
         updateTaintedVars(BB, taintedVars);
 
@@ -57,81 +79,8 @@ int main(int argc, char **argv) {
         // add current block's successor to stack
         // IMPORTANT: Assuming there is no loop in the code to be analysed
         for (auto suc: llvm::successors(BB))
-            dfsStack.emplace(suc, exitVars);
-    }
-
-    printBBVars(BBExitVars);
-
-    return 0;
-}
-
-void printBBVars(const std::map<std::string, instr_set> &BBVars) {
-    for (const auto &[blockName, varSet] : BBVars) {
-        llvm::outs() << blockName << ": {";
-        for (auto itVar = varSet.cbegin(); itVar != varSet.cend(); ++itVar) {
-            if (itVar != varSet.cbegin())
-                llvm::outs() << ", ";
-            llvm::outs() << (*itVar)->getName();
-        }
-        llvm::outs() << "}\n";
-    }
-}
-
-void updateTaintedVars(llvm::BasicBlock* BB, instr_set &taintedVars) {
-    for (auto &I: *BB) {
-        if (I.getName().str() == "source") {
-            // if current instruction is `source` add it to tainted
-            taintedVars.insert(&I);
-        } else {
-            if (llvm::isa<llvm::LoadInst>(I)) {
-                // check if current instruction is loading from a tainted variable
-                auto *instr = llvm::dyn_cast<llvm::LoadInst>(&I);
-                llvm::Value *arg = instr->getOperand(0);
-                auto *argInstr = llvm::dyn_cast<llvm::Instruction>(arg);
-                if (taintedVars.count(argInstr) > 0) {
-                    taintedVars.insert(&I);
-                }
-            } else if (llvm::isa<llvm::BinaryOperator>(I)) {
-                // if it is a binary operator
-                // the result value and two operands must be registers
-                llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
-                auto *leftInstr = llvm::dyn_cast<llvm::Instruction>(left);
-                auto *rightInstr = llvm::dyn_cast<llvm::Instruction>(right);
-                if (taintedVars.count(leftInstr) > 0 || taintedVars.count(rightInstr) > 0)
-                    taintedVars.insert(&I);
-            } else if (llvm::isa<llvm::StoreInst>(I)) {
-                // if current instruction is storing value to variable
-                llvm::Value *val = I.getOperand(0), *var = I.getOperand(1);
-                auto* valInstr = llvm::dyn_cast<llvm::Instruction>(val);
-                auto* varInstr = llvm::dyn_cast<llvm::Instruction>(var);
-                if (taintedVars.count(valInstr) > 0) {
-                    taintedVars.insert(varInstr); // gen
-                } else if (varInstr->getName().str() != "source") {
-                    // un-tainting, assuming `source` cannot be untainted
-                    taintedVars.erase(varInstr); // kill
-                }
-            }
-        }
-    }
-
-    // remove register from the variable set
-    for (auto iter = taintedVars.begin(); iter != taintedVars.end(); ) {
-        if (!llvm::isa<llvm::AllocaInst>(*iter))
-            // if the stored expression is not a variable, remove it from the set
-            taintedVars.erase(iter++);
-        else
-            ++iter;
+            push(suc, exitVars);
     }
 
+    return BBExitVars;
 }
-
-
-// get BasicBlock Label
-std::string getSimpleNodeLabel(const llvm::BasicBlock *Node) {
-    if (!Node->getName().empty())
-        return Node->getName().str();
-    std::string Str;
-    llvm::raw_string_ostream OS(Str);
-    Node->printAsOperand(OS, false);
-    return OS.str();
-}
\ No newline at end of file
@@ -1,7 +1,7 @@
-#include <set>
-#include <map>
+#include <algorithm>
+#include <climits>
+#include <string>
 #include <vector>
-#include <stack>
 
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
@@ -11,164 +11,175 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/CFG.h"
-
-typedef std::map<llvm::Instruction*, std::vector<std::string>> instr_paths_map;
-
-void copyTaintedPaths(instr_paths_map &map, llvm::Instruction *src, llvm::Instruction *dest);
-std::string getSimpleNodeLabel(const llvm::BasicBlock *Node);
-void updateTaintedVarsPaths(llvm::BasicBlock* BB, instr_paths_map &taintedVarsPaths);
-void printVarsPaths(const instr_paths_map &varsPaths);
-void printBBVarsPaths(const std::map<std::string, instr_paths_map> &BBVars);
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/CFG.h"
+#include "llvm/Support/CommandLine.h"
+
+#include "driver.h"
+#include "taintPaths.h"
+#include "utils.h"
+
+static llvm::cl::opt<bool> CountOnly("count", llvm::cl::desc("Print the number of tainting paths instead of the paths"));
+static llvm::cl::opt<std::string> VarName("var", llvm::cl::desc("Only report paths tainting this variable"));
+static llvm::cl::opt<std::string> BlockName("block", llvm::cl::desc("Only report paths to this block"));
+static llvm::cl::opt<unsigned> Limit("limit", llvm::cl::desc("Report at most this many paths per variable and block"),
+                                     llvm::cl::init(UINT_MAX));
+
+// Both print the same: per block, `\tvar: {path, ...}` for every variable with tainting paths (`\tvar: count`
+// with --count), or with a writer a "block" record per block followed by a "path" record per path, or a "paths"
+// record per variable with their number for --count. The numbered paths are sorted, the lazy ones are printed
+// shortest first as soon as they are found.
+void printBBVarsPaths(const TaintPaths &taintPaths, const std::vector<const llvm::BasicBlock*> &blocks, llvm::raw_ostream &OS,
+                      ResultWriter *writer);
+void printLazyPaths(const TaintGraph &graph, const std::vector<const llvm::BasicBlock*> &blocks, llvm::raw_ostream &OS,
+                    ResultWriter *writer);
+std::string pathToString(const std::vector<const llvm::BasicBlock*> &path);
 
 
 int main(int argc, char **argv) {
-
-    // Extract Module M from IR (assuming only one Module exists)
-    // Modules are the top level container of all other LLVM Intermediate Representation (IR) objects.
-    // Read the IR file.
-    llvm::SMDiagnostic Err;
-    llvm::LLVMContext Context;  //A reference to the core LLVM "engine" that you should pass to the various methods that require a LLVMContext.
-    std::unique_ptr<llvm::Module> Mod(parseIRFile(argv[1], Err, Context));
-    if (!Mod) {
-        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
-        return EXIT_FAILURE;
-    }
-
-    // Extract Function main from Module M
-    llvm::Function *F = Mod->getFunction("main");
-
-    // define an exit map recording tainted variables at exits of blocks
-    std::map<std::string, instr_paths_map> BBExitVarsPaths;
-
-    // stack for DFS
-    std::stack<std::pair<llvm::BasicBlock*, instr_paths_map>> dfsStack;
-
-    // initialise dfs with entry block
-    dfsStack.emplace(&F->getEntryBlock(), instr_paths_map());
-    while (!dfsStack.empty()) {
-        auto [BB, taintedVarsPaths] = dfsStack.top();
-        dfsStack.pop();
-        updateTaintedVarsPaths(BB, taintedVarsPaths);
-
-        // since taint analysis is a `may` analysis
-        // use union for different branches
-        std::string blockName = getSimpleNodeLabel(BB);
-        auto &exitVarsPaths = BBExitVarsPaths[blockName];
-        for (auto &[I, paths]: taintedVarsPaths) {
-            std::vector<std::string> &exitPaths = exitVarsPaths[I];
-            std::set<std::string> dedup;
-            std::copy(exitPaths.cbegin(), exitPaths.cend(), std::inserter(dedup, dedup.begin()));
-            std::copy(paths.cbegin(), paths.cend(), std::inserter(dedup, dedup.begin()));
-            exitPaths.clear();
-            std::move(dedup.begin(), dedup.end(), std::back_inserter(exitPaths));
+    return runDriver(argc, argv, "taint paths\n", [](llvm::Function &F, llvm::raw_ostream &OS) {
+        std::vector<const llvm::BasicBlock*> blocks;
+        for (auto BB: llvm::depth_first(&F.getEntryBlock()))
+            if (BlockName.empty() || getSimpleNodeLabel(BB) == BlockName)
+                blocks.push_back(BB);
+        std::sort(blocks.begin(), blocks.end(), [](const llvm::BasicBlock *a, const llvm::BasicBlock *b) {
+            return getSimpleNodeLabel(a) < getSimpleNodeLabel(b);
+        });
+
+        // the numbered paths ignore back edges, so functions with loops take the lazy search; loop free
+        // functions are counted from the numbering, not by enumerating their (exponentially many) paths
+        llvm::SmallVector<std::pair<const llvm::BasicBlock*, const llvm::BasicBlock*>, 8> backEdges;
+        llvm::FindFunctionBackedges(F, backEdges);
+        bool loops = !backEdges.empty();
+        if (loops || (!CountOnly && (!VarName.empty() || !BlockName.empty() || Limit.getNumOccurrences() > 0))) {
+            if (CountOnly && Limit.getNumOccurrences() == 0) {
+                llvm::errs() << "error: " << F.getName() << " has loops, --count needs --limit to bound the search\n";
+                return;
+            }
+            // paths are searched one at a time, shortest first, also works with loops
+            printLazyPaths(TaintGraph(F), blocks, OS, resultWriter(OS).get());
+            return;
         }
 
-
-        // add current block's successor to stack
-        // IMPORTANT: assume there is no loops in the code to be analysed
-        for (auto suc: llvm::successors(BB))
-            dfsStack.emplace(suc, exitVarsPaths);
-    }
-
-    printBBVarsPaths(BBExitVarsPaths);
-
-    return 0;
+        // paths are only decoded when printed, the function is loop free
+        TaintPaths taintPaths(F);
+        printBBVarsPaths(taintPaths, blocks, OS, resultWriter(OS).get());
+    });
 }
 
-void printVarsPaths(const instr_paths_map &varsPaths) {
-    for (const auto& [I, paths]: varsPaths) {
-        llvm::outs() << "\t" << I->getName() << ": {";
-        for (auto itP = paths.cbegin(); itP != paths.cend(); ++itP) {
-            if (itP != paths.cbegin())
-                llvm::outs() << ", ";
-            llvm::outs() << *itP;
-        }
-        llvm::outs() << "}\n";
-    }
+// the variables in the same order as a set of their allocas
+static std::vector<unsigned> varsInSetOrder(const TaintBits &taint) {
+    std::vector<unsigned> vars;
+    for (unsigned var = 0; var < taint.numVars(); ++var)
+        if (VarName.empty() || taint.var(var)->getName() == VarName)
+            vars.push_back(var);
+    std::sort(vars.begin(), vars.end(), [&taint](unsigned a, unsigned b) { return taint.var(a) < taint.var(b); });
+    return vars;
 }
 
-void printBBVarsPaths(const std::map<std::string, instr_paths_map> &BBVarsPaths) {
-    for (const auto &[blockName, varsPaths]: BBVarsPaths) {
-        llvm::outs() << blockName << "\n";
-        printVarsPaths(varsPaths);
+static void printCount(const llvm::AllocaInst *var, uint64_t count, llvm::raw_ostream &OS, ResultWriter *writer) {
+    if (writer) {
+        writer->begin("paths");
+        writer->field("var", var->getName());
+        writer->field("count", static_cast<long long>(count));
+        writer->end();
+    } else {
+        OS << "\t" << var->getName() << ": " << count << "\n";
     }
-
 }
 
-void updateTaintedVarsPaths(llvm::BasicBlock* BB, instr_paths_map &taintedVarsPaths) {
-    // add current Block to all the paths
-    std::string blockName = getSimpleNodeLabel(BB);
-    for (auto &[I, paths]: taintedVarsPaths) {
-        for (auto &p: paths)
-            p.append("->" + blockName);
-    }
-
-    // iterate over instruction to update tainted status
-    for (auto &I: *BB) {
-        if (I.getName().str() == "source") {
-            // if current instruction is `source` add it to tainted
-            std::vector<std::string> &paths = taintedVarsPaths[&I];
-            if (paths.empty())
-                // assume there is only one source from the beginning of the function
-                // so start the path only if the paths is empty
-                paths.emplace_back(blockName);
-        } else {
-            if (llvm::isa<llvm::LoadInst>(I)) {
-                // check if current instruction is loading from a tainted variable
-                auto *instr = llvm::dyn_cast<llvm::LoadInst>(&I);
-                llvm::Value *arg = instr->getOperand(0);
-                auto *argInstr = llvm::dyn_cast<llvm::Instruction>(arg);
-                // copy the instruction's paths to current instruction
-                if (taintedVarsPaths.count(argInstr) > 0)
-                    copyTaintedPaths(taintedVarsPaths, argInstr, &I);
-            } else if (llvm::isa<llvm::BinaryOperator>(I)) {
-                // if it is a binary operator
-                // the result value and two operands must be registers
-                llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
-                auto *leftInstr = llvm::dyn_cast<llvm::Instruction>(left);
-                auto *rightInstr = llvm::dyn_cast<llvm::Instruction>(right);
-                if (taintedVarsPaths.count(leftInstr) > 0)
-                    copyTaintedPaths(taintedVarsPaths, leftInstr, &I);
-                if (taintedVarsPaths.count(rightInstr) > 0)
-                    copyTaintedPaths(taintedVarsPaths, rightInstr, &I);
-            } else if (llvm::isa<llvm::StoreInst>(I)) {
-                // if current instruction is storing value to variable
-                llvm::Value *val = I.getOperand(0), *var = I.getOperand(1);
-                auto* valInstr = llvm::dyn_cast<llvm::Instruction>(val);
-                auto* varInstr = llvm::dyn_cast<llvm::Instruction>(var);
-                if (taintedVarsPaths.count(valInstr) > 0) {
-                    copyTaintedPaths(taintedVarsPaths, valInstr, varInstr);; // gen
-                } else if (varInstr->getName().str() != "source") {
-                    // un-tainting, assuming `source` cannot be untainted
-                    taintedVarsPaths.erase(varInstr); // kill
+void printLazyPaths(const TaintGraph &graph, const std::vector<const llvm::BasicBlock*> &blocks, llvm::raw_ostream &OS,
+                    ResultWriter *writer) {
+    const TaintBits &taint = graph.taint();
+    std::vector<unsigned> vars = varsInSetOrder(taint);
+    for (auto BB: blocks) {
+        if (writer)
+            writer->record("block", "name", getSimpleNodeLabel(BB));
+        else
+            OS << getSimpleNodeLabel(BB) << "\n";
+        for (unsigned var: vars) {
+            TaintPathEnumerator paths(graph, BB, var, Limit);
+            std::string path;
+            if (CountOnly) {
+                // at most --limit paths
+                uint64_t count = 0;
+                while (paths.next(path))
+                    ++count;
+                if (count > 0)
+                    printCount(taint.var(var), count, OS, writer);
+                continue;
+            }
+            bool first = true;
+            for (; paths.next(path); first = false) {
+                if (writer) {
+                    writer->begin("path");
+                    writer->field("var", taint.var(var)->getName());
+                    writer->field("path", path);
+                    writer->end();
+                    writer->flush();
+                    OS.flush();
+                    continue;
                 }
+                // print as soon as found
+                OS << (first ? "\t" + taint.var(var)->getName().str() + ": {" : ", ") << path;
+                OS.flush();
             }
+            if (!writer && !first)
+                OS << "}\n";
         }
     }
+}
 
-    // remove register from the variable set
-    for (auto iter = taintedVarsPaths.begin(); iter != taintedVarsPaths.end(); ) {
-        if (!llvm::isa<llvm::AllocaInst>(iter->first))
-            // if the stored expression is not a variable, remove it from the set
-            taintedVarsPaths.erase(iter++);
+void printBBVarsPaths(const TaintPaths &taintPaths, const std::vector<const llvm::BasicBlock*> &blocks, llvm::raw_ostream &OS,
+                      ResultWriter *writer) {
+    const TaintBits &taint = taintPaths.taint();
+    std::vector<unsigned> vars = varsInSetOrder(taint);
+    for (auto BB: blocks) {
+        if (writer)
+            writer->record("block", "name", getSimpleNodeLabel(BB));
         else
-            ++iter;
+            OS << getSimpleNodeLabel(BB) << "\n";
+
+        for (unsigned var: vars) {
+            uint64_t count = taintPaths.count(BB, var);
+            if (count == 0)
+                continue;
+            llvm::AllocaInst *I = taint.var(var);
+            if (CountOnly) {
+                printCount(I, std::min<uint64_t>(count, Limit), OS, writer);
+                continue;
+            }
+            std::vector<std::string> paths;
+            for (uint64_t id = 0; id < count; ++id)
+                paths.push_back(pathToString(taintPaths.decode(BB, var, id)));
+            std::sort(paths.begin(), paths.end());
+            if (writer) {
+                for (auto &path: paths) {
+                    writer->begin("path");
+                    writer->field("var", I->getName());
+                    writer->field("path", path);
+                    writer->end();
+                }
+                continue;
+            }
+            OS << "\t" << I->getName() << ": {";
+            for (auto itP = paths.cbegin(); itP != paths.cend(); ++itP) {
+                if (itP != paths.cbegin())
+                    OS << ", ";
+                OS << *itP;
+            }
+            OS << "}\n";
+        }
     }
-
 }
 
-void copyTaintedPaths(instr_paths_map &map, llvm::Instruction *src, llvm::Instruction *dest) {
-    auto &additionalPaths = map[src];
-    std::copy(additionalPaths.cbegin(), additionalPaths.cend(), std::back_inserter(map[dest]));
+std::string pathToString(const std::vector<const llvm::BasicBlock*> &path) {
+    std::string str;
+    for (auto BB: path) {
+        if (!str.empty())
+            str.append("->");
+        str.append(getSimpleNodeLabel(BB));
+    }
+    return str;
 }
-
-
-// get BasicBlock Label
-std::string getSimpleNodeLabel(const llvm::BasicBlock *Node) {
-    if (!Node->getName().empty())
-        return Node->getName().str();
-    std::string Str;
-    llvm::raw_string_ostream OS(Str);
-    Node->printAsOperand(OS, false);
-    return OS.str();
-}
\ No newline at end of file
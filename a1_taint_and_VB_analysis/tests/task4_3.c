@@ -0,0 +1,29 @@
+int count;
+
+int id(int x) {
+    return x;
+}
+
+int clean(int x) {
+    return 0;
+}
+
+void leak(int x) {
+    count = x;
+}
+
+int fact(int n, int acc) {
+    if (n <= 1)
+        return acc;
+    return fact(n - 1, acc * n);
+}
+
+int main() {
+    int a, b, c, d, sink, source;
+    a = id(source);
+    b = clean(source);
+    leak(a);
+    c = count;
+    d = fact(source, 1);
+    sink = c + d;
+}
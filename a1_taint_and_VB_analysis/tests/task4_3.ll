@@ -0,0 +1,105 @@
+; ModuleID = 'tests/task4_3.c'
+source_filename = "tests/task4_3.c"
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@count = common dso_local global i32 0, align 4
+
+; Function Attrs: noinline nounwind optnone uwtable
+define dso_local i32 @id(i32 %x) #0 {
+entry:
+  %x.addr = alloca i32, align 4
+  store i32 %x, i32* %x.addr, align 4
+  %0 = load i32, i32* %x.addr, align 4
+  ret i32 %0
+}
+
+; Function Attrs: noinline nounwind optnone uwtable
+define dso_local i32 @clean(i32 %x) #0 {
+entry:
+  %x.addr = alloca i32, align 4
+  store i32 %x, i32* %x.addr, align 4
+  ret i32 0
+}
+
+; Function Attrs: noinline nounwind optnone uwtable
+define dso_local void @leak(i32 %x) #0 {
+entry:
+  %x.addr = alloca i32, align 4
+  store i32 %x, i32* %x.addr, align 4
+  %0 = load i32, i32* %x.addr, align 4
+  store i32 %0, i32* @count, align 4
+  ret void
+}
+
+; Function Attrs: noinline nounwind optnone uwtable
+define dso_local i32 @fact(i32 %n, i32 %acc) #0 {
+entry:
+  %retval = alloca i32, align 4
+  %n.addr = alloca i32, align 4
+  %acc.addr = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32 %acc, i32* %acc.addr, align 4
+  %0 = load i32, i32* %n.addr, align 4
+  %cmp = icmp sle i32 %0, 1
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:                                          ; preds = %entry
+  %1 = load i32, i32* %acc.addr, align 4
+  store i32 %1, i32* %retval, align 4
+  br label %return
+
+if.end:                                           ; preds = %entry
+  %2 = load i32, i32* %n.addr, align 4
+  %sub = sub nsw i32 %2, 1
+  %3 = load i32, i32* %acc.addr, align 4
+  %4 = load i32, i32* %n.addr, align 4
+  %mul = mul nsw i32 %3, %4
+  %call = call i32 @fact(i32 %sub, i32 %mul)
+  store i32 %call, i32* %retval, align 4
+  br label %return
+
+return:                                           ; preds = %if.end, %if.then
+  %5 = load i32, i32* %retval, align 4
+  ret i32 %5
+}
+
+; Function Attrs: noinline nounwind optnone uwtable
+define dso_local i32 @main() #0 {
+entry:
+  %retval = alloca i32, align 4
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = alloca i32, align 4
+  %d = alloca i32, align 4
+  %sink = alloca i32, align 4
+  %source = alloca i32, align 4
+  store i32 0, i32* %retval, align 4
+  %0 = load i32, i32* %source, align 4
+  %call = call i32 @id(i32 %0)
+  store i32 %call, i32* %a, align 4
+  %1 = load i32, i32* %source, align 4
+  %call1 = call i32 @clean(i32 %1)
+  store i32 %call1, i32* %b, align 4
+  %2 = load i32, i32* %a, align 4
+  call void @leak(i32 %2)
+  %3 = load i32, i32* @count, align 4
+  store i32 %3, i32* %c, align 4
+  %4 = load i32, i32* %source, align 4
+  %call2 = call i32 @fact(i32 %4, i32 1)
+  store i32 %call2, i32* %d, align 4
+  %5 = load i32, i32* %c, align 4
+  %6 = load i32, i32* %d, align 4
+  %add = add nsw i32 %5, %6
+  store i32 %add, i32* %sink, align 4
+  %7 = load i32, i32* %retval, align 4
+  ret i32 %7
+}
+
+attributes #0 = { noinline nounwind optnone uwtable "correctly-rounded-divide-sqrt-fp-math"="false" "disable-tail-calls"="false" "less-precise-fpmad"="false" "no-frame-pointer-elim"="true" "no-frame-pointer-elim-non-leaf" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="false" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+fxsr,+mmx,+sse,+sse2,+x87" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 7.0.0-3~ubuntu0.18.04.1 (tags/RELEASE_700/final)"}
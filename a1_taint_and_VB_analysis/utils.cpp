@@ -0,0 +1,113 @@
+#include "utils.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+#include "resultWriter.h"
+
+void printBBVars(const std::map<std::string, instr_set> &BBVars, llvm::raw_ostream &OS) {
+    for (const auto &[blockName, varSet] : BBVars) {
+        OS << blockName << ": {";
+        for (auto itVar = varSet.cbegin(); itVar != varSet.cend(); ++itVar) {
+            if (itVar != varSet.cbegin())
+                OS << ", ";
+            OS << (*itVar)->getName();
+        }
+        OS << "}\n";
+    }
+}
+
+void writeBBVars(const std::map<std::string, instr_set> &BBVars, ResultWriter &writer) {
+    for (const auto &[blockName, varSet] : BBVars) {
+        writer.record("block", "name", blockName);
+        for (auto var: varSet)
+            writer.record("tainted", "var", var->getName());
+    }
+}
+
+std::map<std::string, instr_set> taintFixpoint(llvm::Function &F, FixpointStats *stats) {
+    // one state per block, each block is re-processed only when its entry state grows
+    Fixpoint<instr_set> fixpoint(F, Direction::Forward);
+    fixpoint.run(instr_set(),
+                 [](llvm::BasicBlock *BB, instr_set &taintedVars, const Fixpoint<instr_set>::emit_fn &emit) {
+                     updateTaintedVars(BB, taintedVars);
+                     for (auto suc: llvm::successors(BB))
+                         emit(suc, taintedVars);
+                 },
+                 [](instr_set &into, const instr_set &incoming) {
+                     // since taint analysis is a `may` analysis
+                     // use union for different branches
+                     auto size = into.size();
+                     into.insert(incoming.cbegin(), incoming.cend());
+                     return into.size() != size;
+                 });
+
+    if (stats)
+        *stats = fixpoint.stats();
+
+    std::map<std::string, instr_set> BBExitVars;
+    for (auto BB: fixpoint.blocks())
+        if (fixpoint.reached(BB))
+            BBExitVars[getSimpleNodeLabel(BB)] = fixpoint.out(BB);
+    return BBExitVars;
+}
+
+void updateTaintedVars(llvm::BasicBlock* BB, instr_set &taintedVars) {
+    for (auto &I: *BB) {
+        if (I.getName() == "source") {
+            // if current instruction is `source` add it to tainted
+            taintedVars.insert(&I);
+        } else {
+            if (llvm::isa<llvm::LoadInst>(I)) {
+                // check if current instruction is loading from a tainted variable
+                auto *instr = llvm::dyn_cast<llvm::LoadInst>(&I);
+                llvm::Value *arg = instr->getOperand(0);
+                auto *argInstr = llvm::dyn_cast<llvm::Instruction>(arg);
+                if (taintedVars.count(argInstr) > 0) {
+                    taintedVars.insert(&I);
+                }
+            } else if (llvm::isa<llvm::BinaryOperator>(I)) {
+                // if it is a binary operator
+                // the result value and two operands must be registers
+                llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
+                auto *leftInstr = llvm::dyn_cast<llvm::Instruction>(left);
+                auto *rightInstr = llvm::dyn_cast<llvm::Instruction>(right);
+                if (taintedVars.count(leftInstr) > 0 || taintedVars.count(rightInstr) > 0)
+                    taintedVars.insert(&I);
+            } else if (llvm::isa<llvm::StoreInst>(I)) {
+                // if current instruction is storing value to variable
+                llvm::Value *val = I.getOperand(0), *var = I.getOperand(1);
+                auto* valInstr = llvm::dyn_cast<llvm::Instruction>(val);
+                auto* varInstr = llvm::dyn_cast<llvm::Instruction>(var);
+                if (!varInstr)
+                    // globals are only followed by the interprocedural analysis
+                    continue;
+                if (taintedVars.count(valInstr) > 0) {
+                    taintedVars.insert(varInstr); // gen
+                } else if (varInstr->getName() != "source") {
+                    // un-tainting, assuming `source` cannot be untainted
+                    taintedVars.erase(varInstr); // kill
+                }
+            }
+        }
+    }
+
+    // remove register from the variable set
+    for (auto iter = taintedVars.begin(); iter != taintedVars.end(); ) {
+        if (!llvm::isa<llvm::AllocaInst>(*iter))
+            // if the stored expression is not a variable, remove it from the set
+            taintedVars.erase(iter++);
+        else
+            ++iter;
+    }
+
+}
+
+
+// get BasicBlock Label
+std::string getSimpleNodeLabel(const llvm::BasicBlock *Node) {
+    if (!Node->getName().empty())
+        return Node->getName().str();
+    std::string Str;
+    llvm::raw_string_ostream OS(Str);
+    Node->printAsOperand(OS, false);
+    return OS.str();
+}
@@ -0,0 +1,23 @@
+#ifndef A1_UTILS_H
+#define A1_UTILS_H
+#include <set>
+#include <map>
+#include <string>
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "fixpoint.h"
+
+typedef std::set<llvm::Instruction*> instr_set;
+
+class ResultWriter;
+
+
+std::string getSimpleNodeLabel(const llvm::BasicBlock *Node);
+void updateTaintedVars(llvm::BasicBlock* BB, instr_set &taintedVars);
+void printBBVars(const std::map<std::string, instr_set> &BBVars, llvm::raw_ostream &OS = llvm::outs());
+// the same as a "block" record per block followed by a "tainted" record per variable
+void writeBBVars(const std::map<std::string, instr_set> &BBVars, ResultWriter &writer);
+// tainted variables at the exit of every reachable block, the engine's counters go to `stats` if given
+std::map<std::string, instr_set> taintFixpoint(llvm::Function &F, FixpointStats *stats = nullptr);
+
+#endif //A1_UTILS_H
@@ -0,0 +1,183 @@
+#include "veryBusy.h"
+
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+
+#include "fixpoint.h"
+#include "resultWriter.h"
+#include "utils.h"
+
+BlockVBMap veryBusyFixpoint(llvm::Function &F, const ExprUniverse &universe) {
+    // backward analysis, blocks are processed in post-order starting from the exit blocks
+    Fixpoint<BitVec> fixpoint(F, Direction::Backward);
+    fixpoint.run(BitVec(universe.size()),
+                 [&universe](llvm::BasicBlock *BB, BitVec &busy, const Fixpoint<BitVec>::emit_fn &emit) {
+                     universe.transfer(BB, busy);
+                     for (auto pred: llvm::predecessors(BB))
+                         emit(pred, busy);
+                 },
+                 [](BitVec &into, const BitVec &incoming) {
+                     // meet operator, use intersection
+                     return into.intersectWith(incoming);
+                 });
+
+    // VB pair.first (entry) pair.second (exit)
+    BlockVBMap BBVBMap;
+    for (auto BB: fixpoint.blocks())
+        if (fixpoint.reached(BB)) {
+            BBVBMap.blocks.push_back(BB);
+            BBVBMap.busy[BB] = {fixpoint.out(BB), fixpoint.in(BB)};
+        }
+    return BBVBMap;
+}
+
+void printVB(const ExprUniverse &universe, const BlockVBMap &BBVBMap, llvm::raw_ostream &OS) {
+    for (auto BB: BBVBMap.blocks) {
+        const auto &busyExprs = BBVBMap.busy.at(BB);
+        OS << getSimpleNodeLabel(BB) << "\n";
+        OS << "\tEntry: ";
+        printExprSet(universe, busyExprs.first, OS);
+        OS << "\n";
+        OS << "\tExit: ";
+        printExprSet(universe, busyExprs.second, OS);
+        OS << "\n";
+    }
+}
+
+void writeVB(const ExprUniverse &universe, const BlockVBMap &BBVBMap, ResultWriter &writer) {
+    for (auto BB: BBVBMap.blocks) {
+        const auto &busyExprs = BBVBMap.busy.at(BB);
+        writer.record("block", "name", getSimpleNodeLabel(BB));
+        auto writeSet = [&](llvm::StringRef at, const BitVec &exprs) {
+            exprs.forEach([&](unsigned id) {
+                writer.begin("busy");
+                writer.field("at", at);
+                writer.field("expr", universe.text(id));
+                writer.end();
+            });
+        };
+        writeSet("entry", busyExprs.first);
+        writeSet("exit", busyExprs.second);
+    }
+}
+
+void printExprSet(const ExprUniverse &universe, const BitVec &exprs, llvm::raw_ostream &OS) {
+    OS << "{";
+    bool first = true;
+    exprs.forEach([&](unsigned id) {
+        if (!first) OS << ", ";
+        OS << "\"" << universe.text(id) << "\"";
+        first = false;
+    });
+    OS << "}";
+}
+
+
+ExprUniverse::ExprUniverse(llvm::Function &F) {
+    std::map<expr_key, unsigned> ids;
+    for (auto &BB: F)
+        for (auto &I: BB)
+            if (llvm::isa<llvm::BinaryOperator>(I))
+                intern(I, ids);
+
+    for (const auto &[key, id]: ids)
+        for (const auto *var: {std::get<1>(key).first, std::get<2>(key).first})
+            if (var)
+                killMasks.try_emplace(var, size()).first->second.set(id);
+
+    for (auto &BB: F)
+        summaries.emplace(&BB, summarise(BB));
+}
+
+bool ExprUniverse::getOperand(const llvm::Value *V, operand_key &key, std::string &name) {
+    if (auto *constInt = llvm::dyn_cast<llvm::ConstantInt>(V)) {
+        key = {nullptr, constInt->getSExtValue()};
+        name = constInt->getValue().toString(10, true);
+        return true;
+    }
+    // variables are read through a load of their alloca
+    auto *load = llvm::dyn_cast<llvm::LoadInst>(V);
+    if (!load)
+        return false;
+    auto *var = llvm::dyn_cast<llvm::AllocaInst>(load->getPointerOperand());
+    if (!var)
+        return false;
+    key = {var, 0};
+    name = var->getName().str();
+    return true;
+}
+
+void ExprUniverse::intern(const llvm::Instruction &I, std::map<expr_key, unsigned> &ids) {
+    char opSymbol = opCodeToSymbol(I.getOpcodeName());
+    operand_key left, right;
+    std::string leftName, rightName;
+    // only expressions directly over variables and constants, e.g. not the outer `+` of `a + b + c`
+    if (opSymbol == '\0' || !getOperand(I.getOperand(0), left, leftName) || !getOperand(I.getOperand(1), right, rightName))
+        return;
+    if ((opSymbol == '+' || opSymbol == '*') && right < left)
+        std::swap(left, right);
+
+    auto [it, isNew] = ids.emplace(expr_key(opSymbol, left, right), texts.size());
+    exprIds[&I] = it->second;
+    if (isNew)
+        texts.push_back(leftName + " " + opSymbol + " " + rightName);
+}
+
+ExprUniverse::BlockSummary ExprUniverse::summarise(const llvm::BasicBlock &BB) const {
+    BlockSummary summary{BitVec(size()), BitVec(size())};
+    // backward pass, composing entry = (exit & ~kill) | gen one instruction at a time
+    for (auto it = BB.rbegin(); it != BB.rend(); ++it) {
+        const llvm::Instruction &I = *it;
+        auto expr = exprIds.find(&I);
+        if (expr != exprIds.end())
+            summary.gen.set(expr->second);
+
+        const llvm::Value *var = nullptr;
+        if (auto *store = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+            // if it is not a = a
+            auto *load = llvm::dyn_cast<llvm::LoadInst>(store->getValueOperand());
+            if (!load || load->getPointerOperand() != store->getPointerOperand())
+                var = store->getPointerOperand();
+        } else if (llvm::isa<llvm::AllocaInst>(I)) {
+            var = &I;
+        }
+        auto mask = killMasks.find(var);
+        if (var && mask != killMasks.end()) {
+            summary.gen.subtract(mask->second);
+            summary.kill.unionWith(mask->second);
+        }
+    }
+    return summary;
+}
+
+void ExprUniverse::transfer(const llvm::BasicBlock *BB, BitVec &busy) const {
+    const BlockSummary &summary = summaries.at(BB);
+    busy.subtract(summary.kill);
+    busy.unionWith(summary.gen);
+}
+
+
+char opCodeToSymbol(const std::string &opName) {
+    if (opName.find("add") != std::string::npos) {
+        return '+';
+    }
+
+    if (opName.find("sub") != std::string::npos) {
+        return '-';
+    }
+
+    if (opName.find("mul") != std::string::npos) {
+        return '*';
+    }
+
+    if (opName.find("div") != std::string::npos) {
+        return '/';
+    }
+
+    if (opName.find("rem") != std::string::npos) {
+        return '%';
+    }
+
+    return '\0';
+}
@@ -0,0 +1,73 @@
+#ifndef A1_VERYBUSY_H
+#define A1_VERYBUSY_H
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "bitvec.h"
+
+class ResultWriter;
+
+/*
+ * Gives every distinct binary expression over variables and constants in a function a dense id,
+ * operands of `+` and `*` in canonical order so that `a + b` and `b + a` share one id.
+ * Each block is then summarised as a gen/kill pair over those ids, so the analysis itself runs
+ * on bit vectors only and strings are only built for printing.
+ */
+class ExprUniverse {
+public:
+    explicit ExprUniverse(llvm::Function &F);
+
+    [[nodiscard]] unsigned size() const { return texts.size(); }
+    [[nodiscard]] const std::string &text(unsigned id) const { return texts[id]; }
+
+    // very busy expressions at the entry of `BB` from those at its exit
+    void transfer(const llvm::BasicBlock *BB, BitVec &busy) const;
+
+private:
+    // a variable (its alloca) or a constant
+    typedef std::pair<const llvm::Value *, int64_t> operand_key;
+    typedef std::tuple<char, operand_key, operand_key> expr_key;
+
+    struct BlockSummary {
+        BitVec gen, kill;
+    };
+
+    std::vector<std::string> texts; // as first written in the function
+    std::unordered_map<const llvm::Instruction *, unsigned> exprIds;
+    std::unordered_map<const llvm::Value *, BitVec> killMasks; // expressions using each variable
+    std::unordered_map<const llvm::BasicBlock *, BlockSummary> summaries;
+
+    static bool getOperand(const llvm::Value *V, operand_key &key, std::string &name);
+    void intern(const llvm::Instruction &I, std::map<expr_key, unsigned> &ids);
+    BlockSummary summarise(const llvm::BasicBlock &BB) const;
+};
+
+// very busy expressions at the entry (first) and exit (second) of every reachable block of a function, and the
+// blocks in the order of the fixpoint (post-order), which results are printed in whatever the addresses of the blocks
+struct BlockVBMap {
+    std::vector<llvm::BasicBlock *> blocks;
+    std::unordered_map<const llvm::BasicBlock *, std::pair<BitVec, BitVec>> busy;
+};
+
+BlockVBMap veryBusyFixpoint(llvm::Function &F, const ExprUniverse &universe);
+
+void printVB(const ExprUniverse &universe, const BlockVBMap &BBVBMap, llvm::raw_ostream &OS);
+
+void printExprSet(const ExprUniverse &universe, const BitVec &exprs, llvm::raw_ostream &OS);
+
+// a "block" record per block followed by a "busy" record per expression, at its "entry" or "exit"
+void writeVB(const ExprUniverse &universe, const BlockVBMap &BBVBMap, ResultWriter &writer);
+
+char opCodeToSymbol(const std::string &opName);
+
+#endif //A1_VERYBUSY_H
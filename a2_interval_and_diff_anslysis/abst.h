@@ -7,63 +7,140 @@
 
 #include <iostream>
 #include <climits>
-#include <cmath>
+#include <string>
 
 #include "llvm/Support/raw_ostream.h"
 
-class Abst{
-    friend Abst operator-(const Abst& one);
-    friend Abst operator+(const Abst& one, const Abst& oth);
-    friend Abst operator-(const Abst& one, const Abst& oth);
-    friend Abst operator*(const Abst& one, const Abst& oth);
-    friend Abst operator/(const Abst& one, const Abst& oth);
-    friend Abst operator%(const Abst& one, const Abst& oth);
-    friend bool operator<(const Abst& one, const Abst& oth);
-    friend bool operator>(const Abst& one, const Abst& oth);
-    friend bool operator==(const Abst& one, const Abst& oth);
-    friend bool operator>=(const Abst& one, const Abst& oth);
-    friend bool operator<=(const Abst& one, const Abst& oth);
+/*
+ * Abstract domain: the 32 bit integers, the two infinities and UNDEF, the result of undefined operations.
+ *
+ * Everything is constexpr and inline. The infinities are +-2^62, so far from the finite values that plain
+ * long long arithmetic keeps them beyond MAX / MIN (INF - 15 is still infinite), and an operation is just the
+ * arithmetic, checked with the compiler's overflow builtins, then saturated to the infinities with two
+ * conditional moves. UNDEF is LLONG_MIN, below everything, and only needs one more select.
+ *
+ * As before, INF - INF is 0 and INF / INF is 1.
+ */
+class Abst {
 public:
-    Abst();
-    Abst(int i); // allow implicit conversion
-    Abst(long long l);
-
-    bool isUndef() const;
-    bool isPosInf() const;
-    bool isNegInf() const;
-    bool isInf() const;
-    [[nodiscard]] std::string repr() const;
-    static long long MAX;
-    static long long MIN;
-    const static long long INF = static_cast<long long>(INT_MAX) + 2;
-    const static long long NEG_INF = static_cast<long long>(INT_MIN) - 1;
-    const static long long UNDEF = NEG_INF - 1;
-    static Abst inf();
-    static Abst negInf();
-    static Abst undef();
-    static Abst abs(const Abst&);
+    static constexpr long long INF = 1LL << 62;
+    static constexpr long long NEG_INF = -INF;
+    static constexpr long long UNDEF = LLONG_MIN;
+    // finite values, anything beyond is infinite
+    static constexpr long long MAX = INT_MAX;
+    static constexpr long long MIN = INT_MIN;
+
+    constexpr Abst() = default;
+    constexpr Abst(int i): d(i) {} // allow implicit conversion
+    constexpr Abst(long long l): d(saturate(l)) {}
+
+    [[nodiscard]] constexpr bool isUndef() const { return d == UNDEF; }
+    [[nodiscard]] constexpr bool isPosInf() const { return d == INF; }
+    [[nodiscard]] constexpr bool isNegInf() const { return d == NEG_INF; }
+    [[nodiscard]] constexpr bool isInf() const { return isPosInf() || isNegInf(); }
+    [[nodiscard]] std::string repr() const {
+        if (isPosInf())
+            return "INF";
+        if (isNegInf())
+            return "-INF";
+        if (isUndef())
+            return "UNDEF";
+        return std::to_string(d);
+    }
+
+    // the encoding, for code keeping bounds in plain arrays
+    [[nodiscard]] constexpr long long bits() const { return d; }
+    static constexpr Abst fromBits(long long bits) { return raw(bits); }
+
+    static constexpr Abst inf() { return raw(INF); }
+    static constexpr Abst negInf() { return raw(NEG_INF); }
+    static constexpr Abst undef() { return {}; }
+    // anything is infinitely far from an empty interval, so |UNDEF| is INF
+    static constexpr Abst abs(const Abst &abst) { return raw(abst.isUndef() ? INF : abst.d < 0 ? -abst.d : abst.d); }
+
+    friend constexpr Abst operator-(const Abst &one) {
+        return raw(one.isUndef() ? UNDEF : -one.d);
+    }
+
+    friend constexpr Abst operator+(const Abst &one, const Abst &oth) {
+        long long val = 0;
+        if (__builtin_add_overflow(one.d, oth.d, &val))
+            val = one.d < 0 ? NEG_INF : INF;
+        return defined(one, oth, val);
+    }
+
+    friend constexpr Abst operator-(const Abst &one, const Abst &oth) {
+        long long val = 0;
+        if (__builtin_sub_overflow(one.d, oth.d, &val))
+            val = one.d < 0 ? NEG_INF : INF;
+        return defined(one, oth, val);
+    }
+
+    friend constexpr Abst operator*(const Abst &one, const Abst &oth) {
+        long long val = 0;
+        if (__builtin_mul_overflow(one.d, oth.d, &val))
+            val = (one.d < 0) != (oth.d < 0) ? NEG_INF : INF;
+        return defined(one, oth, val);
+    }
+
+    friend constexpr Abst operator/(const Abst &one, const Abst &oth) {
+        // division by zero is undefined
+        bool undefined = oth.d == 0 || one.isUndef() || oth.isUndef();
+        return undefined ? undef() : raw(saturate(one.d / oth.d));
+    }
+
+    friend constexpr Abst operator%(const Abst &one, const Abst &oth) {
+        bool undefined = oth.d == 0 || one.isInf() || one.isUndef() || oth.isUndef();
+        return undefined ? undef() : raw(one.d % oth.d);
+    }
+
+    friend constexpr bool operator<(const Abst &one, const Abst &oth) { return one.d < oth.d; }
+    friend constexpr bool operator>(const Abst &one, const Abst &oth) { return one.d > oth.d; }
+    friend constexpr bool operator==(const Abst &one, const Abst &oth) { return one.d == oth.d; }
+    friend constexpr bool operator!=(const Abst &one, const Abst &oth) { return one.d != oth.d; }
+    friend constexpr bool operator>=(const Abst &one, const Abst &oth) { return one.d >= oth.d; }
+    friend constexpr bool operator<=(const Abst &one, const Abst &oth) { return one.d <= oth.d; }
+
 private:
     long long d = UNDEF;
-    static Abst abstract(long long val);
-    static long long abstractToLL(long long val);
-};
 
-std::ostream& operator<<(std::ostream &out, const Abst& abst);
-llvm::raw_ostream& operator<<(llvm::raw_ostream &out, const Abst& abst);
+    static constexpr Abst raw(long long val) {
+        Abst abst;
+        abst.d = val;
+        return abst;
+    }
+
+    static constexpr long long saturate(long long val) {
+        val = val > MAX ? INF : val;
+        return val < MIN ? NEG_INF : val;
+    }
 
+    // `val` saturated, unless one of the operands is UNDEF
+    static constexpr Abst defined(const Abst &one, const Abst &oth, long long val) {
+        return raw((one.isUndef() | oth.isUndef()) ? UNDEF : saturate(val));
+    }
+};
 
-Abst operator-(const Abst& one);
-Abst operator+(const Abst& one, const Abst& oth);
-Abst operator-(const Abst& one, const Abst& oth);
-Abst operator*(const Abst& one, const Abst& oth);
-Abst operator/(const Abst& one, const Abst& oth);
-Abst operator%(const Abst& one, const Abst& oth);
-bool operator<(const Abst& one, const Abst& oth);
-bool operator>(const Abst& one, const Abst& oth);
-bool operator==(const Abst& one, const Abst& oth);
-bool operator>=(const Abst& one, const Abst& oth);
-bool operator<=(const Abst& one, const Abst& oth);
+// as repr(), without building a string
+template <typename Stream>
+inline Stream& printAbst(Stream &out, const Abst& abst) {
+    if (abst.isPosInf())
+        out << "INF";
+    else if (abst.isNegInf())
+        out << "-INF";
+    else if (abst.isUndef())
+        out << "UNDEF";
+    else
+        out << abst.bits();
+    return out;
+}
 
+inline std::ostream& operator<<(std::ostream &out, const Abst& abst) {
+    return printAbst(out, abst);
+}
 
+inline llvm::raw_ostream& operator<<(llvm::raw_ostream &out, const Abst& abst) {
+    return printAbst(out, abst);
+}
 
 #endif //A2_ABST_H
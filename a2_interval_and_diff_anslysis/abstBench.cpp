@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "abst.h"
+
+/*
+ * Cost per operation of the inline Abst against the implementation it replaced, kept below as `LegacyAbst`.
+ * Its operations are noinline, as calls into abst.cpp were from every other file, and it reads the
+ * run time bounds `MIN` and `MAX`. The operands are random values in [-1000, 1000], one in 16 of them infinite.
+ */
+
+#define OUT_OF_LINE __attribute__((noinline))
+
+class LegacyAbst {
+public:
+    LegacyAbst() = default;
+    LegacyAbst(int i): d(abstractToLL(i)) {}
+    OUT_OF_LINE bool isUndef() const { return d == UNDEF; }
+    OUT_OF_LINE bool isInf() const { return d == INF || d == NEG_INF; }
+
+    static inline long long MAX = static_cast<long long>(INT_MAX) + 1;
+    static inline long long MIN = static_cast<long long>(INT_MIN);
+    const static long long INF = static_cast<long long>(INT_MAX) + 2;
+    const static long long NEG_INF = static_cast<long long>(INT_MIN) - 1;
+    const static long long UNDEF = NEG_INF - 1;
+
+    static LegacyAbst inf() { return abstract(INF); }
+    static LegacyAbst negInf() { return abstract(NEG_INF); }
+    OUT_OF_LINE static LegacyAbst undef() { return {}; }
+
+    OUT_OF_LINE static long long abstractToLL(long long val) {
+        if (val > MAX)
+            return INF;
+        if (val < MIN)
+            return NEG_INF;
+        return val;
+    }
+
+    OUT_OF_LINE static LegacyAbst abstract(long long val) {
+        LegacyAbst abst;
+        abst.d = abstractToLL(val);
+        return abst;
+    }
+
+    OUT_OF_LINE friend LegacyAbst operator+(const LegacyAbst &one, const LegacyAbst &oth) {
+        if (one.isUndef() || oth.isUndef())
+            return undef();
+        if (one.isInf() && !oth.isInf())
+            return one;
+        return abstract(one.d + oth.d);
+    }
+
+    OUT_OF_LINE friend LegacyAbst operator-(const LegacyAbst &one, const LegacyAbst &oth) {
+        if (one.isUndef() || oth.isUndef())
+            return undef();
+        if (one.isInf() && !oth.isInf())
+            return one;
+        if (oth.isInf() && !one.isInf())
+            return abstract(-oth.d);
+        return abstract(one.d - oth.d);
+    }
+
+    OUT_OF_LINE friend LegacyAbst operator*(const LegacyAbst &one, const LegacyAbst &oth) {
+        if (one.isUndef() || oth.isUndef())
+            return undef();
+        if (oth.d == 0)
+            return abstract(0);
+        return abstract(one.d * oth.d);
+    }
+
+    OUT_OF_LINE friend LegacyAbst operator/(const LegacyAbst &one, const LegacyAbst &oth) {
+        if (one.isUndef() || oth.isUndef())
+            return undef();
+        if (oth.d == 0)
+            return undef();
+        if (one.isInf() && !oth.isInf())
+            return one;
+        return abstract(one.d / oth.d);
+    }
+
+    OUT_OF_LINE friend bool operator<(const LegacyAbst &one, const LegacyAbst &oth) {
+        return one.d < oth.d;
+    }
+
+private:
+    long long d = UNDEF;
+};
+
+const unsigned VALUES = 1 << 12;
+const unsigned ROUNDS = 4000;
+
+// keep the compiler from dropping a result it can see is unused
+template <typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "m"(value) : "memory");
+}
+
+template <typename T>
+std::vector<T> operands(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<T> values;
+    for (unsigned i = 0; i < VALUES; ++i) {
+        unsigned kind = rng() % 32;
+        if (kind == 0)
+            values.push_back(T::inf());
+        else if (kind == 1)
+            values.push_back(T::negInf());
+        else
+            values.push_back(T(int(rng() % 2001) - 1000));
+    }
+    return values;
+}
+
+template <typename T, typename Op>
+double nsPerOp(Op op) {
+    std::vector<T> a = operands<T>(1), b = operands<T>(2);
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < ROUNDS; ++round)
+        for (unsigned i = 0; i < VALUES; ++i)
+            keep(op(a[i], b[i]));
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (double(ROUNDS) * VALUES);
+}
+
+template <template <typename> class Op>
+void row(const char *name) {
+    double legacy = nsPerOp<LegacyAbst>(Op<LegacyAbst>()), inlined = nsPerOp<Abst>(Op<Abst>());
+    llvm::outs() << llvm::format("%9s  %9.2f  %9.2f  %7.1fx\n", name, legacy, inlined, legacy / inlined);
+}
+
+template <typename T>
+struct Max {
+    T operator()(const T &one, const T &oth) const { return std::max(one, oth); }
+};
+
+int main() {
+    llvm::outs() << "operation  legacy ns  inline ns  speedup\n";
+    row<std::plus>("+");
+    row<std::minus>("-");
+    row<std::multiplies>("*");
+    row<std::divides>("/");
+    row<std::less>("<");
+    row<Max>("max");
+    return 0;
+}
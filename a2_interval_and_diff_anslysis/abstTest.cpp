@@ -5,6 +5,13 @@
 #include <vector>
 #include <utility>
 
+// the arithmetic works in constant expressions
+static_assert(Abst(3) + Abst(4) == Abst(7));
+static_assert((Abst(INT_MAX) + Abst(1)).isPosInf());
+static_assert((Abst(15) + Abst::negInf()).isNegInf());
+static_assert(Abst::inf() * Abst::inf() == Abst::inf());
+static_assert((Abst(7) / Abst(0)).isUndef());
+
 int main() {
 //    Abst::MIN = -20;
 //    Abst::MAX = 20;
@@ -0,0 +1,78 @@
+#include "analysisPasses.h"
+
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+
+#include "passPlugin.h"
+
+char IntervalAnalysis::ID = 0;
+char DifferenceAnalysis::ID = 0;
+
+static llvm::RegisterPass<IntervalAnalysis> registerIntervals("value-intervals", "Interval analysis", false, true);
+static llvm::RegisterPass<DifferenceAnalysis> registerDifferences("differences", "Difference analysis", false, true);
+
+static llvm::cl::opt<bool> ReportIntervals("report-intervals", llvm::cl::desc("Print the interval analysis of every function"));
+static llvm::cl::opt<bool> ReportDifferences("report-differences", llvm::cl::desc("Print the difference analysis of every function"));
+static RegisterPrinter<IntervalAnalysis> printIntervals(ReportIntervals);
+static RegisterPrinter<DifferenceAnalysis> printDifferences(ReportDifferences);
+
+bool IntervalAnalysis::runOnFunction(llvm::Function &F) {
+    WideningOptions widening;
+    blocks = intervalFixpoint(F, true, nullptr, &widening);
+    return false;
+}
+
+void IntervalAnalysis::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+}
+
+void IntervalAnalysis::releaseMemory() {
+    blocks.clear();
+}
+
+void IntervalAnalysis::print(llvm::raw_ostream &OS, const llvm::Module *) const {
+    printBBInterval(blocks, OS);
+}
+
+const Interval *IntervalAnalysis::interval(const llvm::BasicBlock *BB, const llvm::Value *var) const {
+    auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(var);
+    auto it = blocks.find(getSimpleNodeLabel(BB));
+    if (!alloca || it == blocks.end())
+        return nullptr;
+    return it->second.lookup(const_cast<llvm::AllocaInst *>(alloca));
+}
+
+bool DifferenceAnalysis::runOnFunction(llvm::Function &F) {
+    WideningOptions widening;
+    slots = std::make_unique<VarSlots>(F);
+    packing = std::make_unique<Packing>(F, *slots);
+    zones = zoneFixpoint(F, *slots, *packing, nullptr, &widening);
+    return false;
+}
+
+void DifferenceAnalysis::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+}
+
+void DifferenceAnalysis::releaseMemory() {
+    // before the packing they refer to
+    zones.clear();
+    packing.reset();
+    slots.reset();
+}
+
+void DifferenceAnalysis::print(llvm::raw_ostream &OS, const llvm::Module *) const {
+    if (slots)
+        printBBZone(zones, *slots, OS);
+}
+
+std::optional<Abst> DifferenceAnalysis::sep(const llvm::BasicBlock *BB, const llvm::Value *x, const llvm::Value *y) const {
+    if (!slots)
+        return std::nullopt;
+    int one = slots->slot(x), other = slots->slot(y);
+    auto it = zones.find(getSimpleNodeLabel(BB));
+    if (one < 0 || other < 0 || it == zones.end() || it->second.isEmpty())
+        return std::nullopt;
+    // numbered from 1 in the zones
+    return it->second.sep(one + 1, other + 1);
+}
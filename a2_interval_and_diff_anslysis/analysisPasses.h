@@ -0,0 +1,69 @@
+#ifndef A2_ANALYSISPASSES_H
+#define A2_ANALYSISPASSES_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "llvm/IR/Function.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "abst.h"
+#include "interval.h"
+#include "intervalState.h"
+#include "utils.h"
+#include "zone.h"
+
+/*
+ * The interval (task3_interval) and difference (task3_diff) analyses as analysis passes, built by `compile_plugin`
+ * into libA2Analyses.so, with the default widening and packing:
+ *     opt-7 -load ./libA2Analyses.so -analyze -value-intervals tests/task2_interval_1.ll
+ *     clang-7 -fno-discard-value-names -Xclang -load -Xclang ./libA2Analyses.so -mllvm -report-differences -c test.c
+ * The interval pass is -value-intervals, LLVM having an -intervals pass of its own. A later pass asks for the cached
+ * results with getAnalysis<IntervalAnalysis>().
+ */
+class IntervalAnalysis : public llvm::FunctionPass {
+public:
+    static char ID;
+    IntervalAnalysis(): FunctionPass(ID) {}
+
+    bool runOnFunction(llvm::Function &F) override;
+    void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+    void releaseMemory() override;
+    // as printed by task3_interval
+    void print(llvm::raw_ostream &OS, const llvm::Module *M) const override;
+
+    // intervals at the exit of every reachable block, by label
+    [[nodiscard]] const std::unordered_map<std::string, instr_interv_map> &blockIntervals() const { return blocks; }
+    // the interval of the variable `var` (its alloca) at the exit of `BB`, nullptr if it has none there
+    [[nodiscard]] const Interval *interval(const llvm::BasicBlock *BB, const llvm::Value *var) const;
+
+private:
+    std::unordered_map<std::string, instr_interv_map> blocks;
+};
+
+class DifferenceAnalysis : public llvm::FunctionPass {
+public:
+    static char ID;
+    DifferenceAnalysis(): FunctionPass(ID) {}
+
+    bool runOnFunction(llvm::Function &F) override;
+    void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+    void releaseMemory() override;
+    // as printed by task3_diff
+    void print(llvm::raw_ostream &OS, const llvm::Module *M) const override;
+
+    // the largest |x - y| of the variables (allocas) `x` and `y` at the exit of `BB`, nullopt if `BB` is not
+    // reached or one of them is not a variable
+    [[nodiscard]] std::optional<Abst> sep(const llvm::BasicBlock *BB, const llvm::Value *x, const llvm::Value *y) const;
+
+private:
+    std::unique_ptr<VarSlots> slots;
+    // the zones refer to it
+    std::unique_ptr<Packing> packing;
+    std::unordered_map<std::string, PackedZone> zones;
+};
+
+#endif //A2_ANALYSISPASSES_H
@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <stack>
+#include <unordered_map>
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "cfgGen.h"
+#include "resultWriter.h"
+#include "intervalState.h"
+#include "sepQuery.h"
+#include "tracePartition.h"
+#include "utils.h"
+#include "zone.h"
+
+/*
+ * Compares the worklist engine used by task3_interval against the DFS driver it replaced,
+ * on generated functions with thousands of blocks.
+ * The DFS driver gives up after `DFS_VISIT_LIMIT` block visits.
+ *
+ * Note the DFS driver stops a path as soon as the union of the states seen at a block stops growing,
+ * although the successors were only ever given the (branch refined) states of single paths, so on the
+ * generated functions it leaves most blocks unreached. The `reached` columns make that visible.
+ *
+ * The second table compares how loops are made to terminate: snapping bounds beyond +-200 to infinity, as
+ * task3_interval did before, against widening at loop heads (with and without the comparison constants as
+ * thresholds) followed by narrowing, for growing loop bounds. `finite` counts the block exit intervals with
+ * both bounds finite.
+ *
+ * The third table runs the same analysis on maps (intervalFixpoint) and on IntervalState (intervalFixpointDense)
+ * for a growing number of variables, and checks both give the same intervals.
+ *
+ * The fourth table runs the difference analysis on intervals and on zones (zoneFixpoint). `finite` counts the
+ * pairs of variables whose sep is finite at a block exit, summed over the blocks.
+ *
+ * The fifth table runs the zones with packing and with a single zone, on functions whose assignments only mix
+ * variables of the same group of 4, and counts the finite seps of the single zone packing makes looser.
+ *
+ * The sixth table prints the seps of the packed results of the same functions: every pair with
+ * printBBZone, and through SepQuery the 5 largest of every block, the pairs of one variable, and one pair.
+ *
+ * The seventh table writes every pair of the same results as text, JSON Lines and binary records to a buffered
+ * stream, next to the time the analysis takes, and checks the binary records decode to as many as there are
+ * JSON lines.
+ *
+ * The eighth table runs the path sensitive interval analysis of task2_interval on loop free functions with
+ * growing numbers of diamonds, keeping a state per trace of the last `depth` branches, and per path (`all`).
+ * `looser` counts the block exit intervals wider than the ones per path.
+ */
+
+const unsigned long long DFS_VISIT_LIMIT = 5000000;
+// task3_interval terminated loops by snapping bounds beyond +-200 to infinity before it widened
+const long long CLAMP = 200;
+
+struct BenchResult {
+    unsigned long long visits = 0;
+    unsigned reached = 0; // number of blocks with a result
+    double ms = 0;
+};
+
+BenchResult runDfs(llvm::Function *F);
+BenchResult runWorklist(llvm::Function *F);
+BenchResult runLoops(llvm::Function *F, const WideningOptions *widening, unsigned &finite);
+BenchResult runDiff(llvm::Function *F, bool zones, unsigned long long &finite);
+BenchResult runPacked(llvm::Function *F, const VarSlots &slots, const Packing &packing,
+                      std::unordered_map<std::string, PackedZone> &BBZone);
+// the time to print and the size of the output, in ms and KB, the output goes to `kept` if given
+std::pair<double, double> timePrint(const std::function<void(llvm::raw_ostream &OS)> &print, std::string *kept = nullptr);
+// the same into a buffered stream only counting the bytes, in ms and MB
+std::pair<double, double> timeWrite(const std::function<void(llvm::raw_ostream &OS)> &write);
+WideningOptions clamping();
+
+
+int main() {
+    llvm::outs() << "statements  blocks  dfs reached  dfs visits  dfs ms  worklist reached  worklist visits  worklist ms\n";
+    for (unsigned statements: {25, 50, 100, 200, 400, 800}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = statements;
+        shape.vars = 8;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        BenchResult dfs = runDfs(F);
+        BenchResult worklist = runWorklist(F);
+        const char *capped = dfs.visits >= DFS_VISIT_LIMIT ? "+" : " ";
+        llvm::outs() << llvm::format("%10u  %6u  %11u  %9llu%s  %6.1f  %15u  %15llu  %11.1f\n", statements, F->size(),
+                                     dfs.reached, dfs.visits, capped, dfs.ms,
+                                     worklist.reached, worklist.visits, worklist.ms);
+    }
+
+    llvm::outs() << "\nloop bound  clamp visits  clamp ms  clamp finite  widen visits  widen ms  widen finite"
+                    "  thresholds visits  thresholds ms  thresholds finite\n";
+    for (unsigned bound: {10, 100, 1000, 100000}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 200;
+        shape.vars = 8;
+        shape.loopBound = bound;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        unsigned clampFinite, widenFinite, thresholdsFinite;
+        WideningOptions clampOnly = clamping();
+        BenchResult clamp = runLoops(F, &clampOnly, clampFinite);
+        WideningOptions widening;
+        BenchResult widen = runLoops(F, &widening, widenFinite);
+        widening.thresholds = true;
+        BenchResult thresholds = runLoops(F, &widening, thresholdsFinite);
+        llvm::outs() << llvm::format("%10u  %12llu  %8.1f  %12u  %12llu  %8.1f  %12u  %17llu  %13.1f  %17u\n", bound,
+                                     clamp.visits, clamp.ms, clampFinite, widen.visits, widen.ms, widenFinite,
+                                     thresholds.visits, thresholds.ms, thresholdsFinite);
+    }
+
+    llvm::outs() << "\nvars  blocks  visits  map ms  dense ms  map us/visit  dense us/visit  speedup  same\n";
+    for (unsigned vars: {8, 32, 128, 512}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 200;
+        shape.vars = vars;
+        shape.loopBound = 1000;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        WideningOptions widening;
+        FixpointStats stats;
+        auto start = std::chrono::steady_clock::now();
+        auto mapped = intervalFixpoint(*F, true, &stats, &widening);
+        double mapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        auto dense = intervalFixpointDense(*F, true, nullptr, &widening);
+        double denseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        llvm::outs() << llvm::format("%4u  %6u  %6llu  %6.1f  %8.1f  %12.2f  %14.2f  %6.1fx  %4s\n", vars, F->size(),
+                                     stats.visits, mapMs, denseMs, 1000 * mapMs / stats.visits,
+                                     1000 * denseMs / stats.visits, mapMs / denseMs, mapped == dense ? "yes" : "no");
+    }
+
+    llvm::outs() << "\nvars  blocks  intervals visits  intervals ms  intervals finite  zone visits  zone ms  zone finite\n";
+    for (unsigned vars: {8, 16, 32, 64}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 200;
+        shape.vars = vars;
+        shape.loopBound = 1000;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        unsigned long long intervalsFinite, zoneFinite;
+        BenchResult intervals = runDiff(F, false, intervalsFinite);
+        BenchResult zone = runDiff(F, true, zoneFinite);
+        llvm::outs() << llvm::format("%4u  %6u  %16llu  %12.1f  %16llu  %11llu  %7.1f  %11llu\n", vars, F->size(),
+                                     intervals.visits, intervals.ms, intervalsFinite, zone.visits, zone.ms, zoneFinite);
+    }
+
+    llvm::outs() << "\nvars  blocks  packs  largest  alone  single ms  packed ms  speedup  finite seps  looser seps\n";
+    for (unsigned vars: {16, 32, 64, 128}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 200;
+        shape.vars = vars;
+        shape.loopBound = 1000;
+        shape.groups = vars / 4;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        VarSlots slots(*F);
+        Packing packing(*F, slots), all(*F, slots, false);
+        unsigned largest = 0;
+        for (auto &pack: packing.packs())
+            largest = std::max<unsigned>(largest, pack.size());
+        std::unordered_map<std::string, PackedZone> singleZone, packedZone;
+        BenchResult single = runPacked(F, slots, all, singleZone);
+        BenchResult packed = runPacked(F, slots, packing, packedZone);
+        unsigned long long finite = 0, looser = 0;
+        for (const auto &[block, zone]: singleZone)
+            for (unsigned x = 1; x <= slots.size(); ++x)
+                for (unsigned y = x + 1; y <= slots.size(); ++y) {
+                    finite += !zone.sep(x, y).isInf();
+                    looser += packedZone[block].sep(x, y) > zone.sep(x, y);
+                }
+        llvm::outs() << llvm::format("%4u  %6u  %5u  %7u  %5u  %9.1f  %9.1f  %6.1fx  %11llu  %11llu\n", vars,
+                                     F->size(), packing.packs().size(), largest, packing.singles(), single.ms,
+                                     packed.ms, single.ms / packed.ms, finite, looser);
+    }
+
+    llvm::outs() << "\nvars  all ms   all KB  top 5 ms  top 5 KB  var ms  var KB  pair ms  pair KB\n";
+    for (unsigned vars: {32, 128, 256}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 200;
+        shape.vars = vars;
+        shape.loopBound = 1000;
+        shape.groups = vars / 4;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        VarSlots slots(*F);
+        Packing packing(*F, slots);
+        std::unordered_map<std::string, PackedZone> BBZone;
+        runPacked(F, slots, packing, BBZone);
+        SepQuery query = sepQuery(BBZone, slots);
+        std::string x = query.name(vars / 2), y = query.name(vars / 2 + 1);
+        SepFilter top, var, pair;
+        top.top = 5;
+        var.vars = {x};
+        pair.pairs = {{x, y}};
+        auto all = timePrint([&](llvm::raw_ostream &OS) { printBBZone(BBZone, slots, OS); });
+        auto topK = timePrint([&](llvm::raw_ostream &OS) { printSeps(query, top, OS); });
+        auto one = timePrint([&](llvm::raw_ostream &OS) { printSeps(query, var, OS); });
+        auto two = timePrint([&](llvm::raw_ostream &OS) { printSeps(query, pair, OS); });
+        llvm::outs() << llvm::format("%4u  %6.1f  %7.0f  %8.1f  %8.0f  %6.1f  %6.0f  %7.2f  %7.0f\n", vars, all.first,
+                                     all.second, topK.first, topK.second, one.first, one.second, two.first, two.second);
+    }
+
+    llvm::outs() << "\nvars  analysis ms  text ms  text MB  jsonl ms  jsonl MB  binary ms  binary MB  records\n";
+    for (unsigned vars: {32, 128, 256}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = 200;
+        shape.vars = vars;
+        shape.loopBound = 1000;
+        shape.groups = vars / 4;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        VarSlots slots(*F);
+        Packing packing(*F, slots);
+        std::unordered_map<std::string, PackedZone> BBZone;
+        BenchResult packed = runPacked(F, slots, packing, BBZone);
+        auto text = timeWrite([&](llvm::raw_ostream &OS) { printBBZone(BBZone, slots, OS); });
+        auto jsonl = timeWrite([&](llvm::raw_ostream &OS) {
+            ResultWriter writer(OS, OutputFormat::JsonLines);
+            writeBBZone(BBZone, slots, writer);
+        });
+        auto binary = timeWrite([&](llvm::raw_ostream &OS) {
+            ResultWriter writer(OS, OutputFormat::Binary);
+            writeBBZone(BBZone, slots, writer);
+        });
+
+        // every record decodes, one per JSON line
+        std::string json, records;
+        timePrint([&](llvm::raw_ostream &OS) {
+            ResultWriter writer(OS, OutputFormat::JsonLines);
+            writeBBZone(BBZone, slots, writer);
+        }, &json);
+        timePrint([&](llvm::raw_ostream &OS) {
+            ResultWriter writer(OS, OutputFormat::Binary);
+            writeBBZone(BBZone, slots, writer);
+        }, &records);
+        size_t lines = std::count(json.begin(), json.end(), '\n'), decoded = 0;
+        BinaryReader reader(records);
+        for (BinaryReader::Record record; reader.next(record);)
+            ++decoded;
+        llvm::outs() << llvm::format("%4u  %11.1f  %7.1f  %7.1f  %8.1f  %8.1f  %9.1f  %9.1f  %7zu%s\n", vars, packed.ms,
+                                     text.first, text.second, jsonl.first, jsonl.second, binary.first, binary.second,
+                                     decoded, decoded == lines ? "" : " (mismatch)");
+    }
+
+    llvm::outs() << "\nstatements  blocks  depth  visits       ms  looser\n";
+    for (unsigned statements: {10, 20, 40, 60}) {
+        llvm::LLVMContext Context;
+        llvm::Module M("bench", Context);
+        CFGShape shape;
+        shape.statements = statements;
+        shape.vars = 8;
+        shape.loops = 0;
+        llvm::Function *F = CFGGenerator(M, shape).generate("main");
+
+        PartitionOptions paths;
+        paths.depth = UINT_MAX;
+        FixpointStats pathStats;
+        auto start = std::chrono::steady_clock::now();
+        auto exact = intervalPartitioned(*F, paths, &pathStats);
+        double pathMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        for (unsigned depth: {0, 2, 4, 8, 16}) {
+            PartitionOptions partitioning;
+            partitioning.depth = depth;
+            FixpointStats stats;
+            start = std::chrono::steady_clock::now();
+            auto partitioned = intervalPartitioned(*F, partitioning, &stats);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            unsigned looser = 0;
+            for (const auto &[block, intervals]: exact)
+                for (const auto &[var, interval]: intervals) {
+                    const Interval *merged = partitioned[block].lookup(var);
+                    looser += !merged || *merged != interval;
+                }
+            llvm::outs() << llvm::format("%10u  %6u  %5u  %6llu  %7.1f  %6u\n", statements, F->size(), depth,
+                                         stats.visits, ms, looser);
+        }
+        llvm::outs() << llvm::format("%10u  %6u  %5s  %6llu  %7.1f  %6u\n", statements, F->size(), static_cast<const char *>("all"),
+                                     pathStats.visits, pathMs, 0);
+    }
+    return 0;
+}
+
+BenchResult runDfs(llvm::Function *F) {
+    // the driver task3_interval used before the worklist engine
+    BenchResult res;
+    auto start = std::chrono::steady_clock::now();
+    std::unordered_map<std::string, instr_interv_map> BBInterv;
+    std::stack<std::pair<llvm::BasicBlock*, instr_interv_map>> dfsStack;
+    dfsStack.emplace(&F->getEntryBlock(), instr_interv_map());
+    while (!dfsStack.empty() && res.visits < DFS_VISIT_LIMIT) {
+        auto [BB, blockInterv] = dfsStack.top();
+        dfsStack.pop();
+        ++res.visits;
+        std::string blockName = getSimpleNodeLabel(BB);
+
+        cmp_interv_map cmpIntervMap;
+        processBlock(BB, blockInterv, &cmpIntervMap);
+
+        auto oldIntervals = BBInterv[blockName];
+        auto &allIntervals = BBInterv[blockName];
+        joinIntervals(allIntervals, blockInterv);
+        clampIntervals(allIntervals, CLAMP);
+        if (oldIntervals == allIntervals)
+            continue;
+
+        auto *br = llvm::dyn_cast<llvm::BranchInst>(BB->getTerminator());
+        if (br && br->isConditional()) {
+            CmpIntervals cmpInterv = cmpIntervMap[llvm::dyn_cast<llvm::Instruction>(br->getCondition())];
+            if (cmpInterv.T.feasible)
+                dfsStack.emplace(br->getSuccessor(0), cmpInterv.T.interv);
+            if (cmpInterv.F.feasible)
+                dfsStack.emplace(br->getSuccessor(1), cmpInterv.F.interv);
+        } else {
+            for (auto suc: llvm::successors(BB))
+                dfsStack.emplace(suc, allIntervals);
+        }
+    }
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.reached = BBInterv.size();
+    return res;
+}
+
+BenchResult runWorklist(llvm::Function *F) {
+    BenchResult res;
+    FixpointStats stats;
+    auto start = std::chrono::steady_clock::now();
+    WideningOptions clampOnly = clamping();
+    res.reached = intervalFixpoint(*F, true, &stats, &clampOnly).size();
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.visits = stats.visits;
+    return res;
+}
+
+BenchResult runLoops(llvm::Function *F, const WideningOptions *widening, unsigned &finite) {
+    BenchResult res;
+    FixpointStats stats;
+    auto start = std::chrono::steady_clock::now();
+    auto BBInterv = intervalFixpoint(*F, true, &stats, widening);
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.visits = stats.visits;
+    res.reached = BBInterv.size();
+    finite = 0;
+    for (const auto &[block, intervals]: BBInterv)
+        for (const auto &[var, interval]: intervals)
+            finite += interval.isFinite();
+    return res;
+}
+
+BenchResult runDiff(llvm::Function *F, bool zones, unsigned long long &finite) {
+    BenchResult res;
+    FixpointStats stats;
+    WideningOptions widening;
+    widening.thresholds = true;
+    finite = 0;
+    auto start = std::chrono::steady_clock::now();
+    if (zones) {
+        // a single zone, see the fifth table for packing
+        VarSlots slots(*F);
+        Packing packing(*F, slots, false);
+        auto BBZone = zoneFixpoint(*F, slots, packing, &stats, &widening);
+        res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        res.reached = BBZone.size();
+        for (const auto &[block, zone]: BBZone)
+            for (unsigned x = 1; x <= slots.size(); ++x)
+                for (unsigned y = x + 1; y <= slots.size(); ++y)
+                    finite += !zone.sep(x, y).isInf();
+    } else {
+        auto BBInterv = intervalFixpoint(*F, true, &stats, &widening);
+        res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        res.reached = BBInterv.size();
+        for (const auto &[block, intervals]: BBInterv)
+            for (auto one = intervals.begin(); one != intervals.end(); ++one)
+                for (auto other = std::next(one); other != intervals.end(); ++other)
+                    finite += !one->second.sep(other->second).isInf();
+    }
+    res.visits = stats.visits;
+    return res;
+}
+
+BenchResult runPacked(llvm::Function *F, const VarSlots &slots, const Packing &packing,
+                      std::unordered_map<std::string, PackedZone> &BBZone) {
+    BenchResult res;
+    FixpointStats stats;
+    WideningOptions widening;
+    widening.thresholds = true;
+    auto start = std::chrono::steady_clock::now();
+    BBZone = zoneFixpoint(*F, slots, packing, &stats, &widening);
+    res.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    res.visits = stats.visits;
+    res.reached = BBZone.size();
+    return res;
+}
+
+std::pair<double, double> timePrint(const std::function<void(llvm::raw_ostream &OS)> &print, std::string *kept) {
+    std::string out;
+    llvm::raw_string_ostream OS(out);
+    auto start = std::chrono::steady_clock::now();
+    print(OS);
+    OS.flush();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double size = out.size() / 1024.0;
+    if (kept)
+        *kept = std::move(out);
+    return {ms, size};
+}
+
+// what a file would see, without the disk
+class CountingStream: public llvm::raw_ostream {
+public:
+    ~CountingStream() override { flush(); }
+
+private:
+    uint64_t bytes = 0;
+
+    void write_impl(const char *, size_t size) override { bytes += size; }
+    uint64_t current_pos() const override { return bytes; }
+};
+
+std::pair<double, double> timeWrite(const std::function<void(llvm::raw_ostream &OS)> &write) {
+    CountingStream OS;
+    auto start = std::chrono::steady_clock::now();
+    write(OS);
+    OS.flush();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return {ms, OS.tell() / double(1 << 20)};
+}
+
+WideningOptions clamping() {
+    WideningOptions options;
+    options.delay = 0;
+    options.narrowingPasses = 0;
+    options.clamp = CLAMP;
+    return options;
+}
@@ -30,6 +30,10 @@ bool Interval::isEmpty() const {
     return l.isUndef() or h.isUndef();
 }
 
+bool Interval::isFinite() const {
+    return !isEmpty() && !l.isInf() && !h.isInf();
+}
+
 Interval Interval::unionWith(const Interval &other) const {
     if (this->isEmpty())
         return other;
@@ -43,6 +47,36 @@ Abst Interval::sep(const Interval& other) const {
 }
 
 
+Interval Interval::widen(const Interval &next, const std::vector<Abst> &thresholds) const {
+    if (this->isEmpty())
+        return next;
+    if (next.isEmpty())
+        return *this;
+    Abst low = this->l, high = this->h;
+    if (next.l < low) {
+        auto it = std::upper_bound(thresholds.begin(), thresholds.end(), next.l);
+        low = it == thresholds.begin() ? Abst::negInf() : *std::prev(it);
+    }
+    if (next.h > high) {
+        auto it = std::lower_bound(thresholds.begin(), thresholds.end(), next.h);
+        high = it == thresholds.end() ? Abst::inf() : *it;
+    }
+    return {low, high};
+}
+
+Interval Interval::narrow(const Interval &next) const {
+    if (this->isEmpty() || next.isEmpty())
+        return Interval::empty();
+    return {this->l.isNegInf() ? next.l : this->l, this->h.isPosInf() ? next.h : this->h};
+}
+
+Interval Interval::clamp(const Abst &bound) const {
+    if (this->isEmpty())
+        return *this;
+    return {this->l < -bound ? Abst::negInf() : this->l, this->h > bound ? Abst::inf() : this->h};
+}
+
+
 std::string Interval::repr() const {
     if (l.isUndef() || h.isUndef())
         return "[empty set]";
@@ -106,14 +140,22 @@ std::pair<Interval, Interval> Interval::geTransfer(const Interval &left, const I
 
 
 
-std::ostream& operator<<(std::ostream &out, const Interval& interv) {
-    out << interv.repr();
+// as repr(), without building a string
+template <typename Stream>
+static Stream& printBounds(Stream &out, const Interval& interv) {
+    if (interv.lower().isUndef() || interv.upper().isUndef())
+        out << "[empty set]";
+    else
+        out << "[" << interv.lower() << ", " << interv.upper() << "]";
     return out;
 }
 
+std::ostream& operator<<(std::ostream &out, const Interval& interv) {
+    return printBounds(out, interv);
+}
+
 llvm::raw_ostream& operator<<(llvm::raw_ostream& out, const Interval& interv) {
-    out << interv.repr();
-    return out;
+    return printBounds(out, interv);
 }
 
 
@@ -143,7 +185,7 @@ Interval operator*(const Interval &one, const Interval &other) {
 }
 
 Interval Interval::posDivision(const Interval a, const Interval b)  {
-    assert((other.l > 0) && "range for b must be strictly positive");
+    assert((b.l > 0) && "range for b must be strictly positive");
     Abst ll = a.l / b.l, lh = a.l / b.h,
             hl = a.h / b.l, hh = a.h / b.h;
     return {std::min({ll, lh, hl, hh}), std::max({ll, lh, hl, hh})};
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <climits>
 #include <string>
+#include <vector>
+#include "llvm/ADT/Hashing.h"
 #include "abst.h"
 
 
@@ -24,10 +26,19 @@ public:
     explicit Interval(Abst c);
     Interval() = default;
     Interval(Abst l, Abst h);
+    [[nodiscard]] Abst lower() const { return l; }
+    [[nodiscard]] Abst upper() const { return h; }
     [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] bool isFinite() const;
     [[nodiscard]] Interval unionWith(const Interval &other) const;
     [[nodiscard]] std::string repr() const;
     [[nodiscard]] Abst sep(const Interval& other) const;
+    // a bound `next` moves beyond goes to the nearest of the sorted `thresholds` past it, or to infinity
+    [[nodiscard]] Interval widen(const Interval &next, const std::vector<Abst> &thresholds = {}) const;
+    // the infinite bounds are replaced by those of `next`
+    [[nodiscard]] Interval narrow(const Interval &next) const;
+    // bounds beyond +-`bound` become infinite
+    [[nodiscard]] Interval clamp(const Abst &bound) const;
 
     static Interval empty();
     static std::pair<Interval, Interval> eqTransfer(const Interval &left, const Interval &right);
@@ -45,6 +56,10 @@ private:
 
 std::ostream& operator<<(std::ostream &out, const Interval &interv);
 llvm::raw_ostream& operator<<(llvm::raw_ostream& out, const Interval& interv);
+// for hashing the states holding intervals, see hashCons.h
+inline llvm::hash_code hash_value(const Interval &interv) {
+    return llvm::hash_combine(interv.lower().bits(), interv.upper().bits());
+}
 
 Interval operator-(const Interval &one);
 Interval operator+(const Interval &one, const Interval &other);
@@ -0,0 +1,363 @@
+#include <algorithm>
+
+#include "intervalState.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/CFG.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define INTERVAL_SIMD
+typedef __m256i lanes;
+const unsigned LANES = 4;
+static inline lanes load(const long long *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+static inline void store(long long *p, lanes v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+static inline lanes splat(long long v) { return _mm256_set1_epi64x(v); }
+static inline lanes greater(lanes a, lanes b) { return _mm256_cmpgt_epi64(a, b); }
+static inline lanes equal(lanes a, lanes b) { return _mm256_cmpeq_epi64(a, b); }
+static inline lanes either(lanes a, lanes b) { return _mm256_or_si256(a, b); }
+static inline lanes both(lanes a, lanes b) { return _mm256_and_si256(a, b); }
+// `b` in the lanes set in `mask`, `a` in the others
+static inline lanes select(lanes mask, lanes a, lanes b) { return _mm256_blendv_epi8(a, b, mask); }
+static inline bool any(lanes mask) { return !_mm256_testz_si256(mask, mask); }
+static inline bool all(lanes mask) { return _mm256_testc_si256(mask, _mm256_set1_epi64x(-1)); }
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define INTERVAL_SIMD
+typedef __m128i lanes;
+const unsigned LANES = 2;
+static inline lanes load(const long long *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+static inline void store(long long *p, lanes v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+static inline lanes splat(long long v) { return _mm_set1_epi64x(v); }
+static inline lanes greater(lanes a, lanes b) { return _mm_cmpgt_epi64(a, b); }
+static inline lanes equal(lanes a, lanes b) { return _mm_cmpeq_epi64(a, b); }
+static inline lanes either(lanes a, lanes b) { return _mm_or_si128(a, b); }
+static inline lanes both(lanes a, lanes b) { return _mm_and_si128(a, b); }
+static inline lanes select(lanes mask, lanes a, lanes b) { return _mm_blendv_epi8(a, b, mask); }
+static inline bool any(lanes mask) { return !_mm_testz_si128(mask, mask); }
+static inline bool all(lanes mask) { return _mm_testc_si128(mask, _mm_set1_epi64x(-1)); }
+#endif
+
+// the bounds of an empty slot
+const long long EMPTY_LO = LLONG_MAX, EMPTY_HI = LLONG_MIN;
+
+IntervalState::IntervalState(unsigned size): lo(size, EMPTY_LO), hi(size, EMPTY_HI) {}
+
+Interval IntervalState::get(unsigned slot) const {
+    if (lo[slot] > hi[slot])
+        return Interval::empty();
+    return {Abst::fromBits(lo[slot]), Abst::fromBits(hi[slot])};
+}
+
+void IntervalState::set(unsigned slot, const Interval &interval) {
+    lo[slot] = interval.isEmpty() ? EMPTY_LO : interval.lower().bits();
+    hi[slot] = interval.isEmpty() ? EMPTY_HI : interval.upper().bits();
+}
+
+bool IntervalState::joinWith(const IntervalState &other) {
+    if (lo.empty()) {
+        // default constructed
+        *this = other;
+        return size() > 0;
+    }
+    unsigned n = size(), i = 0;
+    bool changed = false;
+#ifdef INTERVAL_SIMD
+    lanes grown = splat(0);
+    for (; i + LANES <= n; i += LANES) {
+        lanes l = load(&lo[i]), h = load(&hi[i]), ol = load(&other.lo[i]), oh = load(&other.hi[i]);
+        lanes lower = greater(l, ol), higher = greater(oh, h);
+        store(&lo[i], select(lower, l, ol));
+        store(&hi[i], select(higher, h, oh));
+        grown = either(grown, either(lower, higher));
+    }
+    changed = any(grown);
+#endif
+    for (; i < n; ++i) {
+        changed |= other.lo[i] < lo[i] || other.hi[i] > hi[i];
+        lo[i] = std::min(lo[i], other.lo[i]);
+        hi[i] = std::max(hi[i], other.hi[i]);
+    }
+    return changed;
+}
+
+bool IntervalState::meetWith(const IntervalState &other) {
+    unsigned n = size(), i = 0;
+    bool changed = false;
+#ifdef INTERVAL_SIMD
+    lanes shrunk = splat(0);
+    for (; i + LANES <= n; i += LANES) {
+        lanes l = load(&lo[i]), h = load(&hi[i]), ol = load(&other.lo[i]), oh = load(&other.hi[i]);
+        lanes nl = select(greater(ol, l), l, ol), nh = select(greater(h, oh), h, oh);
+        lanes empty = greater(nl, nh);
+        nl = select(empty, nl, splat(EMPTY_LO));
+        nh = select(empty, nh, splat(EMPTY_HI));
+        shrunk = either(shrunk, either(greater(nl, l), greater(h, nh)));
+        store(&lo[i], nl);
+        store(&hi[i], nh);
+    }
+    changed = any(shrunk);
+#endif
+    for (; i < n; ++i) {
+        long long nl = std::max(lo[i], other.lo[i]), nh = std::min(hi[i], other.hi[i]);
+        if (nl > nh) {
+            nl = EMPTY_LO;
+            nh = EMPTY_HI;
+        }
+        changed |= nl != lo[i] || nh != hi[i];
+        lo[i] = nl;
+        hi[i] = nh;
+    }
+    return changed;
+}
+
+bool IntervalState::widenWith(const IntervalState &other, const std::vector<Abst> &thresholds) {
+    unsigned n = size(), i = 0;
+    bool changed = false;
+    if (!thresholds.empty()) {
+        for (; i < n; ++i) {
+            Interval current = get(i), widened = current.widen(current.unionWith(other.get(i)), thresholds);
+            if (widened != current) {
+                set(i, widened);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+#ifdef INTERVAL_SIMD
+    lanes same = splat(-1);
+    for (; i + LANES <= n; i += LANES) {
+        lanes l = load(&lo[i]), h = load(&hi[i]), ol = load(&other.lo[i]), oh = load(&other.hi[i]);
+        lanes jl = select(greater(l, ol), l, ol), jh = select(greater(oh, h), h, oh);
+        lanes wl = select(greater(l, jl), l, splat(Abst::NEG_INF));
+        lanes wh = select(greater(jh, h), h, splat(Abst::INF));
+        // an empty slot takes the join as is
+        lanes empty = greater(l, h);
+        wl = select(empty, wl, jl);
+        wh = select(empty, wh, jh);
+        same = both(same, both(equal(wl, l), equal(wh, h)));
+        store(&lo[i], wl);
+        store(&hi[i], wh);
+    }
+    changed = !all(same);
+#endif
+    for (; i < n; ++i) {
+        long long jl = std::min(lo[i], other.lo[i]), jh = std::max(hi[i], other.hi[i]);
+        long long wl = lo[i] > hi[i] ? jl : jl < lo[i] ? Abst::NEG_INF : lo[i];
+        long long wh = lo[i] > hi[i] ? jh : jh > hi[i] ? Abst::INF : hi[i];
+        changed |= wl != lo[i] || wh != hi[i];
+        lo[i] = wl;
+        hi[i] = wh;
+    }
+    return changed;
+}
+
+bool IntervalState::narrowWith(const IntervalState &other) {
+    unsigned n = size(), i = 0;
+    bool changed = false;
+#ifdef INTERVAL_SIMD
+    lanes same = splat(-1);
+    for (; i + LANES <= n; i += LANES) {
+        lanes l = load(&lo[i]), h = load(&hi[i]), ol = load(&other.lo[i]), oh = load(&other.hi[i]);
+        lanes nl = select(equal(l, splat(Abst::NEG_INF)), l, ol);
+        lanes nh = select(equal(h, splat(Abst::INF)), h, oh);
+        lanes empty = greater(nl, nh);
+        nl = select(empty, nl, splat(EMPTY_LO));
+        nh = select(empty, nh, splat(EMPTY_HI));
+        lanes keep = either(greater(l, h), greater(ol, oh));
+        nl = select(keep, nl, l);
+        nh = select(keep, nh, h);
+        same = both(same, both(equal(nl, l), equal(nh, h)));
+        store(&lo[i], nl);
+        store(&hi[i], nh);
+    }
+    changed = !all(same);
+#endif
+    for (; i < n; ++i) {
+        if (lo[i] > hi[i] || other.lo[i] > other.hi[i])
+            continue;
+        long long nl = lo[i] == Abst::NEG_INF ? other.lo[i] : lo[i];
+        long long nh = hi[i] == Abst::INF ? other.hi[i] : hi[i];
+        if (nl > nh) {
+            nl = EMPTY_LO;
+            nh = EMPTY_HI;
+        }
+        changed |= nl != lo[i] || nh != hi[i];
+        lo[i] = nl;
+        hi[i] = nh;
+    }
+    return changed;
+}
+
+bool IntervalState::clamp(const Abst &bound) {
+    bool changed = false;
+    for (unsigned i = 0; i < size(); ++i) {
+        Interval current = get(i), clamped = current.clamp(bound);
+        if (clamped != current) {
+            set(i, clamped);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool IntervalState::operator==(const IntervalState &other) const {
+    if (size() != other.size())
+        return false;
+    unsigned n = size(), i = 0;
+#ifdef INTERVAL_SIMD
+    lanes same = splat(-1);
+    for (; i + LANES <= n; i += LANES)
+        same = both(same, both(equal(load(&lo[i]), load(&other.lo[i])), equal(load(&hi[i]), load(&other.hi[i]))));
+    if (!all(same))
+        return false;
+#endif
+    for (; i < n; ++i)
+        if (lo[i] != other.lo[i] || hi[i] != other.hi[i])
+            return false;
+    return true;
+}
+
+
+VarSlots::VarSlots(llvm::Function &F) {
+    for (auto &BB: F)
+        for (auto &I: BB)
+            if (llvm::isa<llvm::AllocaInst>(I)) {
+                slots[&I] = vars.size();
+                vars.push_back(&I);
+            }
+}
+
+int VarSlots::slot(const llvm::Value *V) const {
+    auto it = slots.find(V);
+    return it == slots.end() ? -1 : int(it->second);
+}
+
+instr_interv_map VarSlots::toMap(const IntervalState &state) const {
+    instr_interv_map map;
+    for (unsigned i = 0; i < vars.size() && i < state.size(); ++i)
+        map[vars[i]] = state.get(i);
+    return map;
+}
+
+
+// the states along both outcomes of the conditional branch ending a block
+struct BranchStates {
+    bool feasible[2] = {true, true};
+    IntervalState states[2];
+};
+
+// processBlock on IntervalState, with the registers of the block on the side
+static void processBlock(llvm::BasicBlock *BB, IntervalState &state, const VarSlots &slots, BranchStates *branches) {
+    llvm::DenseMap<const llvm::Value *, Interval> regs;
+    auto value = [&](llvm::Value *V) {
+        if (auto *constInstr = llvm::dyn_cast<llvm::ConstantInt>(V)) {
+            long long val = constInstr->getSExtValue();
+            return Interval(val);
+        }
+        auto it = regs.find(V);
+        return it == regs.end() ? Interval() : it->second;
+    };
+    auto *br = llvm::dyn_cast<llvm::BranchInst>(BB->getTerminator());
+    const llvm::Value *condition = br && br->isConditional() ? br->getCondition() : nullptr;
+
+    for (auto &I: *BB) {
+        if (llvm::isa<llvm::AllocaInst>(I)) {
+            state.set(slots.slot(&I), Interval(Abst::negInf(), Abst::inf()));
+        }
+        else if (auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+            int var = slots.slot(loadInst->getPointerOperand());
+            regs[&I] = var >= 0 ? state.get(var) : value(loadInst->getPointerOperand());
+        }
+        else if (auto *storeInst = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+            int var = slots.slot(storeInst->getPointerOperand());
+            if (var >= 0)
+                state.set(var, value(storeInst->getValueOperand()));
+        }
+        else if (llvm::isa<llvm::BinaryOperator>(I)) {
+            regs[&I] = binaryOperation(value(I.getOperand(0)), value(I.getOperand(1)), I);
+        }
+        else if (branches && &I == condition && llvm::isa<llvm::CmpInst>(I)) {
+            llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
+            Interval leftInterv = value(left), rightInterv = value(right);
+            auto *cmpInst = llvm::dyn_cast<llvm::CmpInst>(&I);
+            std::string pred = llvm::CmpInst::getPredicateName(cmpInst->getPredicate());
+            std::string invPred = llvm::CmpInst::getPredicateName(cmpInst->getInversePredicate());
+
+            // as getCmpInterval and updateValueInterval
+            auto refine = [&](llvm::Value *operand, const Interval &interv, IntervalState &refined) {
+                if (llvm::isa<llvm::Constant>(operand))
+                    return;
+                auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(operand);
+                int var = loadInst ? slots.slot(loadInst->getPointerOperand()) : -1;
+                if (var >= 0)
+                    refined.set(var, interv);
+                else
+                    llvm::errs() << "WARNING: only support x > y not x + 1 > y etc\n";
+            };
+            const std::string *preds[2] = {&pred, &invPred};
+            for (unsigned outcome = 0; outcome < 2; ++outcome) {
+                auto [l, r] = cmpTransfer(leftInterv, rightInterv, *preds[outcome]);
+                branches->feasible[outcome] = !l.isEmpty();
+                if (l.isEmpty())
+                    continue;
+                branches->states[outcome] = state;
+                refine(left, l, branches->states[outcome]);
+                refine(right, r, branches->states[outcome]);
+            }
+        }
+    }
+}
+
+std::unordered_map<std::string, instr_interv_map> intervalFixpointDense(llvm::Function &F, bool refineBranches,
+                                                                        FixpointStats *stats,
+                                                                        const WideningOptions *widening) {
+    VarSlots slots(F);
+    Fixpoint<IntervalState> fixpoint(F, Direction::Forward);
+    Fixpoint<IntervalState>::join_fn join = [](IntervalState &into, const IntervalState &incoming) {
+        return into.joinWith(incoming);
+    };
+    Fixpoint<IntervalState>::join_fn widen;
+    if (widening && widening->clamp) {
+        Abst bound = widening->clamp;
+        widen = [bound](IntervalState &into, const IntervalState &incoming) {
+            bool changed = into.joinWith(incoming);
+            return into.clamp(bound) || changed;
+        };
+    } else if (widening) {
+        auto thresholds = widening->thresholds ? wideningThresholds(F) : std::vector<Abst>();
+        widen = [thresholds](IntervalState &into, const IntervalState &incoming) {
+            return into.widenWith(incoming, thresholds);
+        };
+    }
+    Fixpoint<IntervalState>::transfer_fn transfer =
+            [&slots, refineBranches](llvm::BasicBlock *BB, IntervalState &state, const Fixpoint<IntervalState>::emit_fn &emit) {
+            BranchStates branches;
+            bool refined = false;
+            processBlock(BB, state, slots, refineBranches ? &branches : nullptr);
+
+            auto *br = llvm::dyn_cast<llvm::BranchInst>(BB->getTerminator());
+            if (refineBranches && br && br->isConditional() && llvm::isa<llvm::CmpInst>(br->getCondition())) {
+                refined = true;
+                for (unsigned outcome = 0; outcome < 2; ++outcome)
+                    if (branches.feasible[outcome])
+                        emit(br->getSuccessor(outcome), branches.states[outcome]);
+            }
+            if (!refined)
+                for (auto suc: llvm::successors(BB))
+                    emit(suc, state);
+        };
+    fixpoint.run(IntervalState(slots.size()), transfer, join, widen, widening ? widening->delay : 0);
+    if (widening)
+        fixpoint.descend(IntervalState(slots.size()), transfer, join,
+                         [](IntervalState &into, const IntervalState &incoming) { return into.narrowWith(incoming); },
+                         widening->narrowingPasses);
+
+    if (stats)
+        *stats = fixpoint.stats();
+
+    std::unordered_map<std::string, instr_interv_map> BBInterv;
+    for (auto BB: fixpoint.blocks())
+        if (fixpoint.reached(BB))
+            BBInterv[getSimpleNodeLabel(BB)] = slots.toMap(fixpoint.out(BB));
+    return BBInterv;
+}
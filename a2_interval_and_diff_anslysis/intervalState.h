@@ -0,0 +1,75 @@
+#ifndef A2_INTERVALSTATE_H
+#define A2_INTERVALSTATE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+
+#include "abst.h"
+#include "interval.h"
+#include "utils.h"
+
+/*
+ * The intervals of the variables of a function, structure of arrays: every variable has a dense slot, and the
+ * lower and upper bounds are kept in two arrays of Abst encodings. An empty interval is stored as the lower bound
+ * LLONG_MAX and the upper bound LLONG_MIN, so a join is a lane-wise min and max, a meet a max and min.
+ *
+ * Join, meet, widening, narrowing and equality run 4 slots at a time with AVX2, 2 with SSE4.2, and one at a time
+ * otherwise. A slot never assigned is empty, so unlike `instr_interv_map` the state cannot tell a variable it has
+ * not seen yet from one with an empty interval.
+ */
+class IntervalState {
+public:
+    IntervalState() = default;
+    // every slot empty
+    explicit IntervalState(unsigned size);
+
+    [[nodiscard]] unsigned size() const { return lo.size(); }
+    [[nodiscard]] Interval get(unsigned slot) const;
+    void set(unsigned slot, const Interval &interval);
+
+    // the following return whether the state changed
+    bool joinWith(const IntervalState &other);
+    bool meetWith(const IntervalState &other);
+    // widen with the join of both, see Interval::widen. The thresholds are looked up one slot at a time
+    bool widenWith(const IntervalState &other, const std::vector<Abst> &thresholds = {});
+    // see Interval::narrow, except that the slots empty in `other` are left as they are
+    bool narrowWith(const IntervalState &other);
+    // bounds beyond +-`bound` become infinite
+    bool clamp(const Abst &bound);
+
+    bool operator==(const IntervalState &other) const;
+    bool operator!=(const IntervalState &other) const { return !(*this == other); }
+
+private:
+    std::vector<long long> lo, hi;
+};
+
+/*
+ * Dense slots for the variables (allocas) of a function.
+ */
+class VarSlots {
+public:
+    explicit VarSlots(llvm::Function &F);
+
+    [[nodiscard]] unsigned size() const { return vars.size(); }
+    // -1 if `V` is not a variable
+    [[nodiscard]] int slot(const llvm::Value *V) const;
+    [[nodiscard]] llvm::Instruction *var(unsigned slot) const { return vars[slot]; }
+    // the state as a map, for printing
+    [[nodiscard]] instr_interv_map toMap(const IntervalState &state) const;
+
+private:
+    std::vector<llvm::Instruction *> vars;
+    std::unordered_map<const llvm::Value *, unsigned> slots;
+};
+
+// same as intervalFixpoint, on IntervalState
+std::unordered_map<std::string, instr_interv_map> intervalFixpointDense(llvm::Function &F, bool refineBranches,
+                                                                        FixpointStats *stats = nullptr,
+                                                                        const WideningOptions *widening = nullptr);
+
+#endif //A2_INTERVALSTATE_H
@@ -1,13 +1,12 @@
 #include "interval.h"
 #include "abst.h"
+#include "intervalState.h"
 #include <iostream>
 #include <climits>
 #include <vector>
 #include <utility>
 
 int main() {
-    Abst::MIN = -2000;
-    Abst::MAX = 2000;
     std::vector<std::pair<Interval, Interval>> cases = {
             {{5, 10}, {10, 15}}, {{5, 10}, {10, 199}},
             {{-5, -10}, {-15, -10}}, {{-10, -5}, {-199, -10}},
@@ -58,6 +57,47 @@ int main() {
         std::cout << a << " union " << b << " is " << a.unionWith(b) << std::endl;
     }
 
+    std::cout << std::endl;
+    std::cout << "=== widening ===" << std::endl;
+    std::vector<Abst> thresholds = {-100, 0, 9, 10, 11, 1000};
+    for (const auto &[a, b]: cases) {
+        std::cout << a << " widen " << b << " is " << a.widen(a.unionWith(b)) << std::endl;
+        std::cout << a << " widen " << b << " with thresholds is " << a.widen(a.unionWith(b), thresholds) << std::endl;
+    }
+
+    std::cout << std::endl;
+    std::cout << "=== narrowing ===" << std::endl;
+    for (const auto &[a, b]: cases) {
+        Interval widened = a.widen(a.unionWith(b));
+        std::cout << widened << " narrow " << a.unionWith(b) << " is " << widened.narrow(a.unionWith(b)) << std::endl;
+    }
+
+    std::cout << std::endl;
+    std::cout << "=== dense state ===" << std::endl;
+    // one slot per case, checked against the operations on Interval above
+    IntervalState as(cases.size()), bs(cases.size());
+    for (unsigned i = 0; i < cases.size(); ++i) {
+        as.set(i, cases[i].first);
+        bs.set(i, cases[i].second);
+    }
+    IntervalState joined = as, widened = as, narrowed = as, met = as;
+    joined.joinWith(bs);
+    widened.widenWith(bs);
+    narrowed.widenWith(bs);
+    narrowed.narrowWith(joined);
+    met.meetWith(bs);
+    for (unsigned i = 0; i < cases.size(); ++i) {
+        const auto &[a, b] = cases[i];
+        Interval meet = a.isEmpty() || b.isEmpty() || std::max(a.lower(), b.lower()) > std::min(a.upper(), b.upper())
+                        ? Interval::empty() : Interval(std::max(a.lower(), b.lower()), std::min(a.upper(), b.upper()));
+        std::cout << a << " and " << b << ": join " << joined.get(i) << ", widen " << widened.get(i)
+                  << ", narrow " << narrowed.get(i) << ", meet " << met.get(i)
+                  << (joined.get(i) == a.unionWith(b) && widened.get(i) == a.widen(a.unionWith(b))
+                      && narrowed.get(i) == a.widen(a.unionWith(b)).narrow(a.unionWith(b)) && met.get(i) == meet
+                      ? "" : " MISMATCH") << std::endl;
+    }
+    std::cout << "widened " << (widened == narrowed ? "==" : "!=") << " narrowed" << std::endl;
+
     return 0;
 
     return 0;
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <memory>
+
+#include "resultWriter.h"
+#include "sepQuery.h"
+
+std::optional<SepFilter> sepFilter(const std::vector<std::string> &blocks, const std::vector<std::string> &vars,
+                                   const std::vector<std::string> &pairs, unsigned top) {
+    if (blocks.empty() && vars.empty() && pairs.empty() && !top)
+        return std::nullopt;
+    SepFilter filter;
+    filter.blocks = blocks;
+    filter.vars = vars;
+    // the pairs are x,y, checked by SepPairParser
+    for (auto &pair: pairs) {
+        auto xy = llvm::StringRef(pair).split(',');
+        filter.pairs.emplace_back(xy.first.str(), xy.second.str());
+    }
+    filter.top = top;
+    return filter;
+}
+
+SepQuery::SepQuery(std::vector<std::string> vars): vars(std::move(vars)) {
+    for (unsigned i = 0; i < this->vars.size(); ++i)
+        varIndex.emplace(this->vars[i], i);
+}
+
+void SepQuery::addBlock(const std::string &block, sep_fn sep) {
+    if (blockSeps.emplace(block, std::move(sep)).second)
+        blockNames.push_back(block);
+}
+
+int SepQuery::var(const std::string &name) const {
+    auto it = varIndex.find(name);
+    return it == varIndex.end() ? -1 : int(it->second);
+}
+
+std::optional<Abst> SepQuery::sep(const std::string &block, const std::string &x, const std::string &y) const {
+    auto it = blockSeps.find(block);
+    int one = var(x), other = var(y);
+    if (it == blockSeps.end() || one < 0 || other < 0)
+        return std::nullopt;
+    return it->second(one, other);
+}
+
+std::vector<Sep> SepQuery::top(const std::string &block, unsigned k) const {
+    SepFilter filter;
+    filter.blocks = {block};
+    filter.top = k;
+    std::vector<Sep> seps;
+    forEach(filter, [&seps](const std::string &, const Sep &sep) { seps.push_back(sep); });
+    return seps;
+}
+
+void SepQuery::forEach(const SepFilter &filter, const sep_callback &fn) const {
+    // the pairs to look at, all of them unless filtered
+    std::vector<std::pair<unsigned, unsigned>> pairs;
+    bool all = filter.pairs.empty() && filter.vars.empty();
+    if (!filter.pairs.empty()) {
+        for (auto &[x, y]: filter.pairs)
+            if (var(x) >= 0 && var(y) >= 0 && x != y)
+                pairs.emplace_back(var(x), var(y));
+    } else if (!filter.vars.empty()) {
+        // 1 for the variables of the filter, 2 once their pairs are listed
+        std::vector<char> chosen(vars.size(), 0);
+        for (auto &name: filter.vars)
+            if (var(name) >= 0)
+                chosen[var(name)] = 1;
+        // O(vars) pairs per chosen variable, those of two chosen variables only once
+        for (auto &name: filter.vars) {
+            int x = var(name);
+            if (x < 0 || chosen[x] != 1)
+                continue;
+            chosen[x] = 2;
+            for (unsigned y = 0; y < vars.size(); ++y)
+                if (chosen[y] != 2)
+                    pairs.emplace_back(std::min<unsigned>(x, y), std::max<unsigned>(x, y));
+        }
+    }
+
+    // larger first, then in the order of the variables
+    auto better = [](const Sep &one, const Sep &other) {
+        if (one.value != other.value)
+            return one.value > other.value;
+        return std::make_pair(one.x, one.y) < std::make_pair(other.x, other.y);
+    };
+    const std::vector<std::string> &blocks = filter.blocks.empty() ? blockNames : filter.blocks;
+    for (auto &block: blocks) {
+        auto it = blockSeps.find(block);
+        if (it == blockSeps.end())
+            continue;
+        // the `top` best seps so far, the worst of them at the front
+        std::vector<Sep> heap;
+        auto visit = [&](unsigned x, unsigned y) {
+            std::optional<Abst> value = it->second(x, y);
+            if (!value)
+                return;
+            Sep sep{x, y, *value};
+            if (!filter.top) {
+                fn(block, sep);
+            } else if (heap.size() < filter.top) {
+                heap.push_back(sep);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (better(sep, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = sep;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        };
+        if (all) {
+            for (unsigned x = 0; x < vars.size(); ++x)
+                for (unsigned y = x + 1; y < vars.size(); ++y)
+                    visit(x, y);
+        } else {
+            for (auto &[x, y]: pairs)
+                visit(x, y);
+        }
+        std::sort_heap(heap.begin(), heap.end(), better);
+        for (auto &sep: heap)
+            fn(block, sep);
+    }
+}
+
+// the variables of `slots` but `retval`, and their numbers in the zones (from 1)
+static std::vector<std::string> queryVars(const VarSlots &slots, std::vector<unsigned> &numbers) {
+    std::vector<std::string> names;
+    for (unsigned x = 0; x < slots.size(); ++x) {
+        std::string name = slots.var(x)->getName();
+        if (name == "retval")
+            continue;
+        names.push_back(name);
+        numbers.push_back(x + 1);
+    }
+    return names;
+}
+
+SepQuery sepQuery(const std::unordered_map<std::string, PackedZone> &map, const VarSlots &slots) {
+    auto numbers = std::make_shared<std::vector<unsigned>>();
+    SepQuery query(queryVars(slots, *numbers));
+    for (auto &[block, zone]: map) {
+        const PackedZone *state = &zone;
+        query.addBlock(block, [state, numbers](unsigned x, unsigned y) -> std::optional<Abst> {
+            return state->sep((*numbers)[x], (*numbers)[y]);
+        });
+    }
+    return query;
+}
+
+SepQuery sepQuery(const std::unordered_map<std::string, instr_interv_map> &map, const VarSlots &slots) {
+    auto numbers = std::make_shared<std::vector<unsigned>>();
+    SepQuery query(queryVars(slots, *numbers));
+    for (auto &[block, intervals]: map) {
+        const instr_interv_map *state = &intervals;
+        query.addBlock(block, [state, numbers, &slots](unsigned x, unsigned y) -> std::optional<Abst> {
+            const Interval *one = state->lookup(slots.var((*numbers)[x] - 1));
+            const Interval *other = state->lookup(slots.var((*numbers)[y] - 1));
+            if (!one || !other)
+                return std::nullopt;
+            return one->sep(*other);
+        });
+    }
+    return query;
+}
+
+void printSeps(const SepQuery &query, const SepFilter &filter, llvm::raw_ostream &OS) {
+    // blocks without a sep to print are left out
+    const std::string *current = nullptr;
+    query.forEach(filter, [&](const std::string &block, const Sep &sep) {
+        if (!current || *current != block) {
+            if (current)
+                OS << "\n";
+            OS << block << ":\n";
+            current = &block;
+        }
+        OS << "sep(" << query.name(sep.x) << ", " << query.name(sep.y) << ") = " << sep.value << "\n";
+    });
+}
+
+void writeSeps(const SepQuery &query, const SepFilter &filter, ResultWriter &writer) {
+    const std::string *current = nullptr;
+    query.forEach(filter, [&](const std::string &block, const Sep &sep) {
+        if (!current || *current != block) {
+            writer.record("block", "name", block);
+            current = &block;
+        }
+        writer.begin("sep");
+        writer.field("x", query.name(sep.x));
+        writer.field("y", query.name(sep.y));
+        writeAbst(writer, "sep", sep.value);
+        writer.end();
+    });
+}
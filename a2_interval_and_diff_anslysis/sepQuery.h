@@ -0,0 +1,100 @@
+#ifndef A2_SEPQUERY_H
+#define A2_SEPQUERY_H
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "abst.h"
+#include "intervalState.h"
+#include "utils.h"
+#include "zone.h"
+
+// the sep of the variables x and y (numbered as in the query) at a block
+struct Sep {
+    unsigned x, y;
+    Abst value;
+};
+
+// which seps a query returns, everything by default
+struct SepFilter {
+    std::vector<std::string> blocks;
+    // pairs with at least one of these variables
+    std::vector<std::string> vars;
+    // only these pairs, `vars` is then ignored
+    std::vector<std::pair<std::string, std::string>> pairs;
+    // only the `top` largest seps of every block, largest first, 0 for all
+    unsigned top = 0;
+};
+
+// parser of the --pair option, rejects a value that is not x,y instead of leaving the pair out of the query
+struct SepPairParser : llvm::cl::parser<std::string> {
+    explicit SepPairParser(llvm::cl::Option &O): llvm::cl::parser<std::string>(O) {}
+
+    bool parse(llvm::cl::Option &O, llvm::StringRef argName, llvm::StringRef arg, std::string &value) {
+        auto xy = arg.split(',');
+        if (xy.first.empty() || xy.second.empty())
+            return O.error("expects x,y", argName);
+        value = arg.str();
+        return false;
+    }
+};
+
+// the filter of the --block, --var, --pair (x,y, see SepPairParser) and --top options of the drivers, nullopt
+// if none is given
+std::optional<SepFilter> sepFilter(const std::vector<std::string> &blocks, const std::vector<std::string> &vars,
+                                   const std::vector<std::string> &pairs, unsigned top);
+
+/*
+ * Queries on the result of a difference analysis. A block only holds a function computing the sep of two
+ * variables from its state, so a query costs the seps it looks at: a lookup one, the pairs of a variable
+ * O(vars), and only a query on every pair of a block O(vars^2). Seps are passed on as they are computed, and
+ * the top k of a block are kept in a heap of k entries.
+ *
+ * The query refers to the states of the analysis and to the VarSlots, which must outlive it.
+ */
+class SepQuery {
+public:
+    // nullopt if the block has no state for one of the variables
+    typedef std::function<std::optional<Abst>(unsigned x, unsigned y)> sep_fn;
+    typedef std::function<void(const std::string &block, const Sep &sep)> sep_callback;
+
+    explicit SepQuery(std::vector<std::string> vars);
+    void addBlock(const std::string &block, sep_fn sep);
+
+    [[nodiscard]] const std::string &name(unsigned var) const { return vars[var]; }
+    // -1 if there is no such variable
+    [[nodiscard]] int var(const std::string &name) const;
+    [[nodiscard]] const std::vector<std::string> &blocks() const { return blockNames; }
+
+    // nullopt for an unknown block or variable
+    [[nodiscard]] std::optional<Abst> sep(const std::string &block, const std::string &x, const std::string &y) const;
+    // the `k` largest seps at `block`, largest first
+    [[nodiscard]] std::vector<Sep> top(const std::string &block, unsigned k) const;
+    // calls `fn` with the seps `filter` selects, block by block
+    void forEach(const SepFilter &filter, const sep_callback &fn) const;
+
+private:
+    std::vector<std::string> vars;
+    std::unordered_map<std::string, unsigned> varIndex;
+    std::vector<std::string> blockNames;
+    std::unordered_map<std::string, sep_fn> blockSeps;
+};
+
+// queries on the results of zoneFixpoint and of the interval based analyses, over the variables of `slots`
+// except `retval`
+SepQuery sepQuery(const std::unordered_map<std::string, PackedZone> &map, const VarSlots &slots);
+SepQuery sepQuery(const std::unordered_map<std::string, instr_interv_map> &map, const VarSlots &slots);
+// the seps `filter` selects, in the format of printBBDifference
+void printSeps(const SepQuery &query, const SepFilter &filter, llvm::raw_ostream &OS = llvm::outs());
+// the same as writeBBDifference, blocks without a sep to write are left out
+void writeSeps(const SepQuery &query, const SepFilter &filter, ResultWriter &writer);
+
+#endif //A2_SEPQUERY_H
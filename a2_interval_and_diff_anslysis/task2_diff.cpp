@@ -2,6 +2,7 @@
 #include <map>
 #include <unordered_map>
 #include <stack>
+#include <utility>
 
 
 #include "llvm/IR/LLVMContext.h"
@@ -12,90 +13,100 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/Support/CommandLine.h"
 
+#include "driver.h"
+#include "hashCons.h"
 #include "interval.h"
+#include "sepQuery.h"
 #include "utils.h"
+#include "zone.h"
 
-typedef std::stack<std::pair<llvm::BasicBlock*, instr_interv_map>> dfs_stack;
+typedef std::stack<std::pair<llvm::BasicBlock*, const instr_interv_map*>> dfs_stack;
 
-std::string getSimpleNodeLabel(const llvm::BasicBlock *Node);
-void processBlock(llvm::BasicBlock *BB, instr_interv_map &intervMap);
+static llvm::cl::opt<bool> Intervals("intervals", llvm::cl::desc("Compute sep from the intervals of the two variables instead of a zone"));
+static llvm::cl::opt<bool> NoPacking("no-packing", llvm::cl::desc("Keep all the variables in a single zone instead of one zone per pack"));
+static llvm::cl::opt<bool> PackStats("pack-stats", llvm::cl::desc("Print the sizes of the packs, and the analysis time with and without them, to stderr"));
+static llvm::cl::list<std::string> Blocks("block", llvm::cl::desc("Only print the seps at this block"));
+static llvm::cl::list<std::string> Vars("var", llvm::cl::desc("Only print the seps of this variable with the others"));
+static llvm::cl::list<std::string, bool, SepPairParser> Pairs("pair", llvm::cl::desc("Only print the sep of these two variables, given as x,y"));
+static llvm::cl::opt<unsigned> Top("top", llvm::cl::desc("Only print the k largest seps of every block"), llvm::cl::init(0));
 
+std::unordered_map<std::string, instr_interv_map> differenceDfs(llvm::Function &F);
 
-int main(int argc, char **argv) {
-
-    // Extract Module M from IR (assuming only one Module exists)
-    // Modules are the top level container of all other LLVM Intermediate Representation (IR) objects.
-    // Read the IR file.
-    llvm::SMDiagnostic Err;
-    llvm::LLVMContext Context;  //A reference to the core LLVM "engine" that you should pass to the various methods that require a LLVMContext.
-    std::unique_ptr<llvm::Module> Mod(parseIRFile(argv[1], Err, Context));
-    if (!Mod) {
-        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
-        return EXIT_FAILURE;
-    }
 
-    // Extract Function main from Module M
-    llvm::Function *F = Mod->getFunction("main");
+int main(int argc, char **argv) {
+    return runDriver(argc, argv, "difference analysis\n", [](llvm::Function &F, llvm::raw_ostream &OS) {
+        // only the seps asked for, if any
+        std::optional<SepFilter> filter = sepFilter({Blocks.begin(), Blocks.end()}, {Vars.begin(), Vars.end()},
+                                                    {Pairs.begin(), Pairs.end()}, Top);
+        if (!Intervals) {
+            // no loops, so no widening
+            VarSlots slots(F);
+            Packing packing(F, slots, !NoPacking);
+            if (PackStats)
+                reportPacking(F, slots, packing, nullptr);
+            std::unordered_map<std::string, PackedZone> BBZone = zoneFixpoint(F, slots, packing);
+            if (auto writer = resultWriter(OS)) {
+                if (filter)
+                    writeSeps(sepQuery(BBZone, slots), *filter, *writer);
+                else
+                    writeBBZone(BBZone, slots, *writer);
+            } else if (filter) {
+                printSeps(sepQuery(BBZone, slots), *filter, OS);
+            } else {
+                printBBZone(BBZone, slots, OS);
+            }
+            return;
+        }
+        std::unordered_map<std::string, instr_interv_map> BBInterv = differenceDfs(F);
+        auto writer = resultWriter(OS);
+        if (filter) {
+            VarSlots slots(F);
+            if (writer)
+                writeSeps(sepQuery(BBInterv, slots), *filter, *writer);
+            else
+                printSeps(sepQuery(BBInterv, slots), *filter, OS);
+        } else if (writer) {
+            writeBBDifference(BBInterv, *writer);
+        } else {
+            printBBDifference(BBInterv, OS);
+        }
+    });
+}
 
+std::unordered_map<std::string, instr_interv_map> differenceDfs(llvm::Function &F) {
     std::unordered_map<std::string, instr_interv_map> BBInterv;
 
+    // the states pushed are interned, and a (block, state) pair pushed before is dropped: a block only pushes
+    // the join of the states it has seen, which the earlier push of the pair already did
+    HashCons<instr_interv_map> states;
+    std::set<std::pair<llvm::BasicBlock*, const instr_interv_map*>> pushed;
+
     // stack for DFS
     dfs_stack dfsStack;
+    auto push = [&](llvm::BasicBlock *BB, const instr_interv_map &intervMap) {
+        const instr_interv_map *state = states.intern(intervMap);
+        if (pushed.emplace(BB, state).second)
+            dfsStack.emplace(BB, state);
+    };
 
     // initialise dfs with entry block
-    dfsStack.emplace(&F->getEntryBlock(), instr_interv_map());
+    push(&F.getEntryBlock(), instr_interv_map());
     while (!dfsStack.empty()) {
-        auto [BB, intervMap] = dfsStack.top();
+        auto [BB, state] = dfsStack.top();
         dfsStack.pop();
+        instr_interv_map intervMap = *state;
         processBlock(BB, intervMap);
 
         std::string blockName = getSimpleNodeLabel(BB);
         auto &allIntervals = BBInterv[blockName];
-        for (auto &[k, v]: intervMap) {
-            allIntervals[k] = allIntervals[k].unionWith(v);
-        }
+        joinIntervals(allIntervals, intervMap);
         // assume no loop
         for (auto suc: llvm::successors(BB))
-            dfsStack.emplace(suc, allIntervals);
-
-    }
-    printBBDifference(BBInterv);
-
-    return 0;
-}
-
-void processBlock(llvm::BasicBlock *BB, instr_interv_map &intervMap) {
-    for (auto &I: *BB) {
-        if (llvm::isa<llvm::AllocaInst>(I)) {
-            intervMap[&I] = Interval(Abst::negInf(), Abst::inf());
-        }
-        else if (llvm::isa<llvm::LoadInst>(I)) {
-            auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(&I);
-            auto *argInstr = llvm::dyn_cast<llvm::Instruction>(loadInst->getOperand(0));
-            intervMap[&I] = extractInterval(argInstr, intervMap);
-        }
-        else if (llvm::isa<llvm::StoreInst>(I)) {
-            llvm::Value *val = I.getOperand(0), *var = I.getOperand(1);
-            auto* varInstr = llvm::dyn_cast<llvm::Instruction>(var);
-            intervMap[varInstr] = extractInterval(val, intervMap);
-        }
-        else if (llvm::isa<llvm::BinaryOperator>(I)) {
-            // if it is a binary operator
-            // the result value and two operands must be registers
-            llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
-            Interval leftInterv = extractInterval(left, intervMap);
-            Interval rightInterv = extractInterval(right, intervMap);
-            intervMap[&I] = binaryOperation(leftInterv, rightInterv, I);
-        }
-    }
+            push(suc, allIntervals);
 
-    // remove register's interval
-    for (auto it = intervMap.begin(); it != intervMap.end();) {
-        if (!llvm::isa<llvm::AllocaInst>(it->first))
-            intervMap.erase(it++);
-        else
-            ++it;
     }
 
+    return BBInterv;
 }
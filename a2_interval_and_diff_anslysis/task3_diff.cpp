@@ -1,7 +1,6 @@
 #include <set>
 #include <map>
 #include <unordered_map>
-#include <stack>
 
 
 #include "llvm/IR/LLVMContext.h"
@@ -12,96 +11,70 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/Support/CommandLine.h"
 
+#include "driver.h"
 #include "interval.h"
+#include "intervalState.h"
+#include "sepQuery.h"
 #include "utils.h"
-
-typedef std::stack<std::pair<llvm::BasicBlock*, instr_interv_map>> dfs_stack;
-
-std::string getSimpleNodeLabel(const llvm::BasicBlock *Node);
-void processBlock(llvm::BasicBlock *BB, instr_interv_map &intervMap);
-
+#include "zone.h"
+
+static llvm::cl::opt<unsigned> WideningDelay("widening-delay", llvm::cl::desc("Join this many states into a loop head before widening it"),
+                                             llvm::cl::init(1));
+static llvm::cl::opt<bool> WideningThresholds("widening-thresholds", llvm::cl::desc("Widen bounds to the constants of the comparisons before infinity"));
+static llvm::cl::opt<unsigned> NarrowingPasses("narrowing-passes", llvm::cl::desc("At most this many descending passes after widening"),
+                                               llvm::cl::init(4));
+static llvm::cl::opt<bool> Intervals("intervals", llvm::cl::desc("Compute sep from the intervals of the two variables instead of a zone"));
+static llvm::cl::opt<bool> NoPacking("no-packing", llvm::cl::desc("Keep all the variables in a single zone instead of one zone per pack"));
+static llvm::cl::opt<bool> PackStats("pack-stats", llvm::cl::desc("Print the sizes of the packs, and the analysis time with and without them, to stderr"));
+static llvm::cl::list<std::string> Blocks("block", llvm::cl::desc("Only print the seps at this block"));
+static llvm::cl::list<std::string> Vars("var", llvm::cl::desc("Only print the seps of this variable with the others"));
+static llvm::cl::list<std::string, bool, SepPairParser> Pairs("pair", llvm::cl::desc("Only print the sep of these two variables, given as x,y"));
+static llvm::cl::opt<unsigned> Top("top", llvm::cl::desc("Only print the k largest seps of every block"), llvm::cl::init(0));
+static llvm::cl::opt<bool> Dense("dense", llvm::cl::desc("Keep the intervals of a block in dense arrays (IntervalState) instead of a map"));
 
 int main(int argc, char **argv) {
-
-    // Extract Module M from IR (assuming only one Module exists)
-    // Modules are the top level container of all other LLVM Intermediate Representation (IR) objects.
-    // Read the IR file.
-    llvm::SMDiagnostic Err;
-    llvm::LLVMContext Context;  //A reference to the core LLVM "engine" that you should pass to the various methods that require a LLVMContext.
-    std::unique_ptr<llvm::Module> Mod(parseIRFile(argv[1], Err, Context));
-    if (!Mod) {
-        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
-        return EXIT_FAILURE;
-    }
-
-    // Extract Function main from Module M
-    llvm::Function *F = Mod->getFunction("main");
-
-    /*
-     * Since there is loop we set Abst::MIN to -200 and Abst::MAX to 200 for guaranteed termination
-     * values less than Abst::min are treated as -inf, more than Abst::max as inf
-     */
-    Abst::MIN = -200;
-    Abst::MAX = 200;
-
-    std::unordered_map<std::string, instr_interv_map> BBInterv;
-
-    // stack for DFS
-    dfs_stack dfsStack;
-
-
-    dfsStack.emplace(&F->getEntryBlock(), instr_interv_map());
-    while (!dfsStack.empty()) {
-        auto [BB, intervMap] = dfsStack.top();
-        dfsStack.pop();
-        processBlock(BB, intervMap);
-
-        std::string blockName = getSimpleNodeLabel(BB);
-        // save a copy
-        auto oldIntervals = BBInterv[blockName];
-        auto &allIntervals = BBInterv[blockName];
-        for (auto &[k, v]: intervMap) {
-            allIntervals[k] = allIntervals[k].unionWith(v);
+    return runDriver(argc, argv, "difference analysis\n", [](llvm::Function &F, llvm::raw_ostream &OS) {
+        // loops terminate by widening the states at their heads, narrowed again afterwards
+        WideningOptions widening;
+        widening.delay = WideningDelay;
+        widening.thresholds = WideningThresholds;
+        widening.narrowingPasses = NarrowingPasses;
+        // only the seps asked for, if any
+        std::optional<SepFilter> filter = sepFilter({Blocks.begin(), Blocks.end()}, {Vars.begin(), Vars.end()},
+                                                    {Pairs.begin(), Pairs.end()}, Top);
+        if (!Intervals) {
+            VarSlots slots(F);
+            Packing packing(F, slots, !NoPacking);
+            if (PackStats)
+                reportPacking(F, slots, packing, &widening);
+            std::unordered_map<std::string, PackedZone> BBZone = zoneFixpoint(F, slots, packing, nullptr, &widening);
+            if (auto writer = resultWriter(OS)) {
+                if (filter)
+                    writeSeps(sepQuery(BBZone, slots), *filter, *writer);
+                else
+                    writeBBZone(BBZone, slots, *writer);
+            } else if (filter) {
+                printSeps(sepQuery(BBZone, slots), *filter, OS);
+            } else {
+                printBBZone(BBZone, slots, OS);
+            }
+            return;
         }
-
-        // only add the suc if fixpoint is not reached
-        if (oldIntervals != allIntervals) {
-            for (auto suc: llvm::successors(BB))
-                dfsStack.emplace(suc, allIntervals);
-        }
-    }
-    printBBDifference(BBInterv);
-
-    return 0;
-}
-
-void processBlock(llvm::BasicBlock *BB, instr_interv_map &intervMap) {
-    for (auto &I: *BB) {
-        if (llvm::isa<llvm::AllocaInst>(I)) {
-            intervMap[&I] = Interval(Abst::negInf(), Abst::inf());
+        std::unordered_map<std::string, instr_interv_map> BBInterv = Dense ? intervalFixpointDense(F, false, nullptr, &widening)
+                                                                            : intervalFixpoint(F, false, nullptr, &widening);
+        auto writer = resultWriter(OS);
+        if (filter) {
+            VarSlots slots(F);
+            if (writer)
+                writeSeps(sepQuery(BBInterv, slots), *filter, *writer);
+            else
+                printSeps(sepQuery(BBInterv, slots), *filter, OS);
+        } else if (writer) {
+            writeBBDifference(BBInterv, *writer);
+        } else {
+            printBBDifference(BBInterv, OS);
         }
-        else if (llvm::isa<llvm::LoadInst>(I)) {
-            auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(&I);
-            auto *argInstr = llvm::dyn_cast<llvm::Instruction>(loadInst->getOperand(0));
-            intervMap[&I] = extractInterval(argInstr, intervMap);
-        }
-        else if (llvm::isa<llvm::StoreInst>(I)) {
-            llvm::Value *val = I.getOperand(0), *var = I.getOperand(1);
-            auto* varInstr = llvm::dyn_cast<llvm::Instruction>(var);
-            intervMap[varInstr] = extractInterval(val, intervMap);
-        }
-        else if (llvm::isa<llvm::BinaryOperator>(I)) {
-            // if it is a binary operator
-            // the result value and two operands must be registers
-            llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
-            Interval leftInterv = extractInterval(left, intervMap);
-            Interval rightInterv = extractInterval(right, intervMap);
-            intervMap[&I] = binaryOperation(leftInterv, rightInterv, I);
-        }
-    }
-
-    // remove register's interval
-    removeReg(intervMap);
-
+    });
 }
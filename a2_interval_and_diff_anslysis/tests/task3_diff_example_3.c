@@ -0,0 +1,8 @@
+int main() {
+    int i = 0, j = 10;
+    while (i < 100) {
+        i++;
+        j++;
+    }
+    return 0;
+}
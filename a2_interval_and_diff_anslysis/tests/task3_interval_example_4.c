@@ -0,0 +1,12 @@
+int main() {
+    int i = 0, j, s = 0;
+    while (i < 100000) {
+        j = 0;
+        while (j < 1000) {
+            j++;
+        }
+        s = j;
+        i++;
+    }
+    return 0;
+}
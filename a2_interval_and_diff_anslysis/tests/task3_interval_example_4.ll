@@ -0,0 +1,56 @@
+; ModuleID = 'tests/task3_interval_example_4.c'
+source_filename = "tests/task3_interval_example_4.c"
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+; Function Attrs: noinline nounwind optnone uwtable
+define dso_local i32 @main() #0 {
+entry:
+  %retval = alloca i32, align 4
+  %i = alloca i32, align 4
+  %j = alloca i32, align 4
+  %s = alloca i32, align 4
+  store i32 0, i32* %retval, align 4
+  store i32 0, i32* %i, align 4
+  store i32 0, i32* %s, align 4
+  br label %while.cond
+
+while.cond:                                       ; preds = %while.end, %entry
+  %0 = load i32, i32* %i, align 4
+  %cmp = icmp slt i32 %0, 100000
+  br i1 %cmp, label %while.body, label %while.end4
+
+while.body:                                       ; preds = %while.cond
+  store i32 0, i32* %j, align 4
+  br label %while.cond1
+
+while.cond1:                                      ; preds = %while.body3, %while.body
+  %1 = load i32, i32* %j, align 4
+  %cmp2 = icmp slt i32 %1, 1000
+  br i1 %cmp2, label %while.body3, label %while.end
+
+while.body3:                                      ; preds = %while.cond1
+  %2 = load i32, i32* %j, align 4
+  %inc = add nsw i32 %2, 1
+  store i32 %inc, i32* %j, align 4
+  br label %while.cond1
+
+while.end:                                        ; preds = %while.cond1
+  %3 = load i32, i32* %j, align 4
+  store i32 %3, i32* %s, align 4
+  %4 = load i32, i32* %i, align 4
+  %inc5 = add nsw i32 %4, 1
+  store i32 %inc5, i32* %i, align 4
+  br label %while.cond
+
+while.end4:                                       ; preds = %while.cond
+  ret i32 0
+}
+
+attributes #0 = { noinline nounwind optnone uwtable "correctly-rounded-divide-sqrt-fp-math"="false" "disable-tail-calls"="false" "less-precise-fpmad"="false" "no-frame-pointer-elim"="true" "no-frame-pointer-elim-non-leaf" "no-infs-fp-math"="false" "no-jump-tables"="false" "no-nans-fp-math"="false" "no-signed-zeros-fp-math"="false" "no-trapping-math"="false" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+fxsr,+mmx,+sse,+sse2,+x87" "unsafe-fp-math"="false" "use-soft-float"="false" }
+
+!llvm.module.flags = !{!0}
+!llvm.ident = !{!1}
+
+!0 = !{i32 1, !"wchar_size", i32 4}
+!1 = !{!"clang version 7.0.0-3~ubuntu0.18.04.1 (tags/RELEASE_700/final)"}
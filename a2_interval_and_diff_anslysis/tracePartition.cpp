@@ -0,0 +1,83 @@
+#include "tracePartition.h"
+
+#include <map>
+#include <vector>
+
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Instructions.h"
+
+// the outcomes of the last branches, oldest first, as 2 * (number of the branch block) + (0 if taken, 1 if not)
+typedef std::vector<unsigned> trace;
+
+std::unordered_map<std::string, instr_interv_map> intervalPartitioned(llvm::Function &F, const PartitionOptions &options,
+                                                                      FixpointStats *stats) {
+    std::unordered_map<std::string, instr_interv_map> BBInterv;
+    FixpointStats counts;
+
+    llvm::ReversePostOrderTraversal<llvm::Function *> RPOT(&F);
+    std::vector<llvm::BasicBlock *> order(RPOT.begin(), RPOT.end());
+    std::unordered_map<llvm::BasicBlock *, unsigned> number;
+    for (unsigned i = 0; i < order.size(); ++i)
+        number[order[i]] = i;
+    // the states waiting at the entry of every block, by trace
+    std::vector<std::map<trace, instr_interv_map>> partitions(order.size());
+    partitions[0].emplace(trace(), instr_interv_map());
+
+    auto emit = [&](unsigned from, llvm::BasicBlock *to, const trace &key, const instr_interv_map &state) {
+        unsigned target = number[to];
+        // the edge back to a loop head, the states are never merged into one
+        if (target <= from)
+            return;
+        auto [it, inserted] = partitions[target].emplace(key, state);
+        if (!inserted) {
+            joinIntervals(it->second, state);
+            ++counts.joins;
+        }
+    };
+
+    for (unsigned i = 0; i < order.size(); ++i) {
+        llvm::BasicBlock *BB = order[i];
+        std::string blockName = getSimpleNodeLabel(BB);
+        auto *br = llvm::dyn_cast<llvm::BranchInst>(BB->getTerminator());
+        bool conditional = br && br->isConditional();
+        bool partitioned = conditional && options.depth &&
+                           (options.branches.empty() || options.branches.count(blockName));
+        if (partitions[i].empty())
+            continue;
+        auto &allIntervals = BBInterv[blockName];
+
+        for (auto &[key, blockInterv]: partitions[i]) {
+            ++counts.visits;
+            cmp_interv_map cmpIntervMap;
+            processBlock(BB, blockInterv, &cmpIntervMap);
+            joinIntervals(allIntervals, blockInterv);
+            counts.largestState = std::max<unsigned long long>(counts.largestState, blockInterv.size());
+
+            if (!conditional) {
+                for (auto suc: llvm::successors(BB))
+                    emit(i, suc, key, blockInterv);
+                continue;
+            }
+            CmpIntervals cmpInterv = cmpIntervMap[llvm::dyn_cast<llvm::Instruction>(br->getCondition())];
+            const CmpBrInterval *outcomes[] = {&cmpInterv.T, &cmpInterv.F};
+            for (unsigned outcome = 0; outcome < 2; ++outcome) {
+                if (!outcomes[outcome]->feasible)
+                    continue;
+                if (!partitioned) {
+                    emit(i, br->getSuccessor(outcome), key, outcomes[outcome]->interv);
+                    continue;
+                }
+                // forget the oldest outcome beyond the depth
+                trace next(key.size() < options.depth ? key.begin() : key.begin() + 1, key.end());
+                next.push_back(2 * i + outcome);
+                emit(i, br->getSuccessor(outcome), next, outcomes[outcome]->interv);
+            }
+        }
+        partitions[i].clear();
+    }
+
+    if (stats)
+        *stats += counts;
+    return BBInterv;
+}
@@ -0,0 +1,33 @@
+#ifndef A2_TRACEPARTITION_H
+#define A2_TRACEPARTITION_H
+
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "llvm/IR/Function.h"
+
+#include "fixpoint.h"
+#include "utils.h"
+
+/*
+ * Trace partitioning for the path sensitive interval analysis of task 2. Instead of a state per path, which makes
+ * 2^n states out of n branches one after the other, a block keeps a state per trace: the outcomes of the last
+ * `depth` branches the paths reaching it took. Paths agreeing on those are merged, so a block has at most 2^depth
+ * states and the analysis runs in O(2^depth * blocks) transfers. A depth at least the number of branches on a path
+ * is the state per path, and 0 merges every path at every block.
+ *
+ * With `branches`, only the branches ending these blocks (by label) count in the traces, the states coming out
+ * of the others being merged right away, to spend the budget on the branches whose outcomes matter.
+ */
+struct PartitionOptions {
+    unsigned depth = 8;
+    std::set<std::string> branches; // every branch if empty
+};
+
+// intervals at the exit of every reachable block of the loop free function `F`, joined over the traces reaching
+// it. The blocks are visited once each in reverse post-order, a loop is only run through once
+std::unordered_map<std::string, instr_interv_map> intervalPartitioned(llvm::Function &F, const PartitionOptions &options,
+                                                                      FixpointStats *stats = nullptr);
+
+#endif //A2_TRACEPARTITION_H
@@ -2,7 +2,10 @@
 // Created by wayne on 3/23/24.
 //
 #include "utils.h"
+#include <algorithm>
 #include <iterator>
+#include "llvm/IR/CFG.h"
+#include "resultWriter.h"
 
 Interval extractInterval(llvm::Value *V, instr_interv_map& map) {
     if (llvm::isa<llvm::Constant>(V)) {
@@ -11,17 +14,84 @@ Interval extractInterval(llvm::Value *V, instr_interv_map& map) {
         return Interval(val);
     }
     auto *I = llvm::dyn_cast<llvm::Instruction>(V);
-    return map[I];
+    const Interval *interv = map.lookup(I);
+    return interv ? *interv : Interval();
 }
 
-void removeReg(instr_interv_map &intervMap) {
-    // remove register's interval
-    for (auto it = intervMap.begin(); it != intervMap.end();) {
-        if (!llvm::isa<llvm::AllocaInst>(it->first))
-            intervMap.erase(it++);
-        else
-            ++it;
+// sets each variable of `incoming` to `update` of its interval in `into` (empty if missing) and in `incoming`.
+// `update(v, v)` must be `v`, so the nodes both maps share are skipped, and with `insert` unset, so are the
+// variables missing from `into`. Returns whether any interval changed
+template <typename Update>
+static bool updateIntervals(instr_interv_map &into, const instr_interv_map &incoming, bool insert, Update update) {
+    std::vector<std::pair<llvm::Instruction*, Interval>> updates;
+    bool changed = false;
+    into.forEachUnshared(incoming, [&](const std::pair<llvm::Instruction*, Interval> &entry) {
+        const Interval *interv = into.lookup(entry.first);
+        if (!interv && !insert)
+            return;
+        Interval current = interv ? *interv : Interval(), next = update(current, entry.second);
+        changed |= next != current;
+        if (!interv || next != current)
+            updates.emplace_back(entry.first, next);
+    });
+    for (const auto &[k, v]: updates)
+        into[k] = v;
+    return changed;
+}
+
+bool joinIntervals(instr_interv_map &into, const instr_interv_map &incoming) {
+    return updateIntervals(into, incoming, true, [](const Interval &interv, const Interval &v) {
+        return interv.unionWith(v);
+    });
+}
+
+bool widenIntervals(instr_interv_map &into, const instr_interv_map &incoming, const std::vector<Abst> &thresholds) {
+    return updateIntervals(into, incoming, true, [&thresholds](const Interval &interv, const Interval &v) {
+        return interv.widen(interv.unionWith(v), thresholds);
+    });
+}
+
+bool narrowIntervals(instr_interv_map &into, const instr_interv_map &incoming) {
+    return updateIntervals(into, incoming, false, [](const Interval &interv, const Interval &v) {
+        return interv.narrow(v);
+    });
+}
+
+bool clampIntervals(instr_interv_map &map, const Abst &bound) {
+    std::vector<std::pair<llvm::Instruction*, Interval>> clamped;
+    for (const auto &[k, v]: map) {
+        Interval interv = v.clamp(bound);
+        if (interv != v)
+            clamped.emplace_back(k, interv);
     }
+    for (const auto &[k, v]: clamped)
+        map[k] = v;
+    return !clamped.empty();
+}
+
+std::vector<Abst> wideningThresholds(llvm::Function &F) {
+    std::vector<Abst> thresholds;
+    for (auto &BB: F)
+        for (auto &I: BB) {
+            if (!llvm::isa<llvm::CmpInst>(I))
+                continue;
+            for (auto &op: I.operands())
+                if (auto *constant = llvm::dyn_cast<llvm::ConstantInt>(op)) {
+                    // strict comparisons bound the variable one past the constant
+                    long long val = constant->getSExtValue();
+                    thresholds.insert(thresholds.end(), {Abst(val - 1), Abst(val), Abst(val + 1)});
+                }
+        }
+    std::sort(thresholds.begin(), thresholds.end());
+    thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+    return thresholds;
+}
+
+void removeReg(instr_interv_map &intervMap, llvm::BasicBlock *BB) {
+    // remove register's interval, only the block being processed has any in the map
+    for (auto &I: *BB)
+        if (!llvm::isa<llvm::AllocaInst>(I))
+            intervMap.erase(&I);
 }
 
 Interval binaryOperation(const Interval& left, const Interval& right, const llvm::Instruction &I) {
@@ -47,19 +117,19 @@ Interval binaryOperation(const Interval& left, const Interval& right, const llvm
     }
 
     printInstruction(I);
-    llvm::outs() << "undefined binary operation: " << opName << "\n";
+    llvm::errs() << "undefined binary operation: " << opName << "\n";
 
     return {Abst::undef(), Abst::undef()};
 }
 
 
-void printBBDifference(std::unordered_map<std::string, instr_interv_map> &map) {
+void printBBDifference(const std::unordered_map<std::string, instr_interv_map> &map, llvm::raw_ostream &OS) {
     // print interval first
     for (auto it = map.cbegin(); it != map.cend(); ++it) {
         if (it != map.cbegin())
-            llvm::outs() << "\n";
+            OS << "\n";
         auto blockName = it->first;
-        llvm::outs() << blockName << ":\n";
+        OS << blockName << ":\n";
         auto &varInterv = it->second;
         for (auto it2 = varInterv.cbegin(); it2 != varInterv.cend(); ++it2) {
             std::string var1 = it2->first->getName();
@@ -70,29 +140,225 @@ void printBBDifference(std::unordered_map<std::string, instr_interv_map> &map) {
                 if (var2 == "retval")
                     continue;
                 Abst diff = it2->second.sep(it3->second);
-                llvm::outs() << "sep(" << var1 << ", " << var2 << ") = " << diff << "\n";
+                OS << "sep(" << var1 << ", " << var2 << ") = " << diff << "\n";
             }
         }
     }
 }
 
-void printBBInterval(std::unordered_map<std::string, instr_interv_map> &map) {
+void printBBInterval(const std::unordered_map<std::string, instr_interv_map> &map, llvm::raw_ostream &OS) {
     // print interval first
     for (auto it = map.cbegin(); it != map.cend(); ++it) {
         if (it != map.cbegin())
-            llvm::outs() << "\n";
+            OS << "\n";
         auto blockName = it->first;
-        llvm::outs() << blockName << ":\n";
-        printInterval(it->second);
+        OS << blockName << ":\n";
+        printInterval(it->second, OS);
     }
 }
 
-void printInterval(const instr_interv_map &map) {
+void printInterval(const instr_interv_map &map, llvm::raw_ostream &OS) {
     for (const auto &[k, v]: map) {
         std::string varName = k->getName();
         if (varName != "retval")
-            llvm::outs() << varName << ": " << v << "\n";
+            OS << varName << ": " << v << "\n";
+    }
+}
+
+void writeBBInterval(const std::unordered_map<std::string, instr_interv_map> &map, ResultWriter &writer) {
+    for (auto &[blockName, varInterv]: map) {
+        writer.record("block", "name", blockName);
+        for (const auto &[k, v]: varInterv) {
+            if (k->getName() == "retval")
+                continue;
+            writer.begin("interval");
+            writer.field("var", k->getName());
+            writeAbst(writer, "lo", v.lower());
+            writeAbst(writer, "hi", v.upper());
+            writer.end();
+        }
+    }
+}
+
+void writeBBDifference(const std::unordered_map<std::string, instr_interv_map> &map, ResultWriter &writer) {
+    std::vector<std::pair<llvm::StringRef, Interval>> vars;
+    for (auto &[blockName, varInterv]: map) {
+        writer.record("block", "name", blockName);
+        // looked up once, a name is not stored in the value
+        vars.clear();
+        for (const auto &[k, v]: varInterv)
+            if (k->getName() != "retval")
+                vars.emplace_back(k->getName(), v);
+        for (auto one = vars.begin(); one != vars.end(); ++one)
+            for (auto other = std::next(one); other != vars.end(); ++other) {
+                writer.begin("sep");
+                writer.field("x", one->first);
+                writer.field("y", other->first);
+                writeAbst(writer, "sep", one->second.sep(other->second));
+                writer.end();
+            }
+    }
+}
+
+void writeAbst(ResultWriter &writer, llvm::StringRef name, const Abst &value) {
+    if (value.isPosInf())
+        writer.field(name, "inf");
+    else if (value.isNegInf())
+        writer.field(name, "-inf");
+    else if (value.isUndef())
+        writer.field(name, "undef");
+    else
+        writer.field(name, value.bits());
+}
+
+
+std::unordered_map<std::string, instr_interv_map> intervalFixpoint(llvm::Function &F, bool refineBranches, FixpointStats *stats,
+                                                                   const WideningOptions *widening) {
+    Fixpoint<instr_interv_map> fixpoint(F, Direction::Forward);
+    Fixpoint<instr_interv_map>::join_fn widen;
+    if (widening && widening->clamp) {
+        Abst bound = widening->clamp;
+        widen = [bound](instr_interv_map &into, const instr_interv_map &incoming) {
+            bool changed = joinIntervals(into, incoming);
+            return clampIntervals(into, bound) || changed;
+        };
+    } else if (widening) {
+        auto thresholds = widening->thresholds ? wideningThresholds(F) : std::vector<Abst>();
+        widen = [thresholds](instr_interv_map &into, const instr_interv_map &incoming) {
+            return widenIntervals(into, incoming, thresholds);
+        };
     }
+    Fixpoint<instr_interv_map>::transfer_fn transfer =
+            [refineBranches](llvm::BasicBlock *BB, instr_interv_map &blockInterv, const Fixpoint<instr_interv_map>::emit_fn &emit) {
+            cmp_interv_map cmpIntervMap;
+            processBlock(BB, blockInterv, refineBranches ? &cmpIntervMap : nullptr);
+
+            auto *br = llvm::dyn_cast<llvm::BranchInst>(BB->getTerminator());
+            if (refineBranches && br && br->isConditional()) {
+                auto *cmpInstr = llvm::dyn_cast<llvm::Instruction>(br->getCondition());
+                const CmpIntervals &cmpInterv = cmpIntervMap[cmpInstr];
+                // true branch
+                if (cmpInterv.T.feasible)
+                    emit(br->getSuccessor(0), cmpInterv.T.interv);
+                // false branch
+                if (cmpInterv.F.feasible)
+                    emit(br->getSuccessor(1), cmpInterv.F.interv);
+            } // unconditional jump
+            else {
+                for (auto suc: llvm::successors(BB))
+                    emit(suc, blockInterv);
+            }
+        };
+    fixpoint.run(instr_interv_map(), transfer, joinIntervals, widen, widening ? widening->delay : 0);
+    if (widening)
+        fixpoint.descend(instr_interv_map(), transfer, joinIntervals, narrowIntervals, widening->narrowingPasses);
+
+    if (stats)
+        *stats = fixpoint.stats();
+
+    std::unordered_map<std::string, instr_interv_map> BBInterv;
+    for (auto BB: fixpoint.blocks())
+        if (fixpoint.reached(BB))
+            BBInterv[getSimpleNodeLabel(BB)] = fixpoint.out(BB);
+    return BBInterv;
+}
+
+void processBlock(llvm::BasicBlock *BB, instr_interv_map &intervMap, cmp_interv_map *cmpIntervMap) {
+    for (auto &I: *BB) {
+        if (llvm::isa<llvm::AllocaInst>(I)) {
+            intervMap[&I] = Interval(Abst::negInf(), Abst::inf());
+        }
+        else if (llvm::isa<llvm::LoadInst>(I)) {
+            auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(&I);
+            auto *argInstr = llvm::dyn_cast<llvm::Instruction>(loadInst->getOperand(0));
+            intervMap[&I] = extractInterval(argInstr, intervMap);
+        }
+        else if (llvm::isa<llvm::StoreInst>(I)) {
+            llvm::Value *val = I.getOperand(0), *var = I.getOperand(1);
+            auto* varInstr = llvm::dyn_cast<llvm::Instruction>(var);
+            intervMap[varInstr] = extractInterval(val, intervMap);
+        }
+        else if (llvm::isa<llvm::BinaryOperator>(I)) {
+            // if it is a binary operator
+            // the result value and two operands must be registers
+            llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
+            Interval leftInterv = extractInterval(left, intervMap);
+            Interval rightInterv = extractInterval(right, intervMap);
+            intervMap[&I] = binaryOperation(leftInterv, rightInterv, I);
+        }
+        else if (cmpIntervMap && llvm::isa<llvm::CmpInst>(I)) {
+            llvm::Value *left = I.getOperand(0), *right = I.getOperand(1);
+            Interval leftInterv = extractInterval(left, intervMap);
+            Interval rightInterv = extractInterval(right, intervMap);
+            auto *cmpInst = llvm::dyn_cast<llvm::CmpInst>(&I);
+            std::string pred = llvm::CmpInst::getPredicateName(cmpInst->getPredicate());
+            std::string invPred = llvm::CmpInst::getPredicateName(cmpInst->getInversePredicate());
+
+            CmpIntervals &cmp = (*cmpIntervMap)[&I];
+            // for True
+            auto [t_left, t_right] = cmpTransfer(leftInterv, rightInterv, pred);
+            cmp.T = getCmpInterval(intervMap, BB, left, right, t_left, t_right);
+            // for false
+            auto [f_left, f_right] = cmpTransfer(leftInterv, rightInterv, invPred);
+            cmp.F = getCmpInterval(intervMap, BB, left, right, f_left, f_right);
+        }
+    }
+
+    removeReg(intervMap, BB);
+}
+
+
+CmpBrInterval getCmpInterval(instr_interv_map map, llvm::BasicBlock *BB, llvm::Value *left, llvm::Value *right,
+                             const Interval &leftInterv, const Interval &rightInterv) {
+    CmpBrInterval intervs;
+    if (leftInterv.isEmpty()) {
+        intervs.feasible = false;
+        return intervs;
+    }
+    intervs.feasible = true;
+    updateValueInterval(map, left, leftInterv);
+    updateValueInterval(map, right, rightInterv);
+    removeReg(map, BB);
+    intervs.interv = map;
+    return intervs;
+}
+
+void updateValueInterval(instr_interv_map &map, llvm::Value *val, const Interval& interv) {
+    if (llvm::isa<llvm::Constant>(val))
+        return;
+    // else it is a load instruction since we only consider (x > y) not (x + 1 > y)
+    auto *I = llvm::dyn_cast<llvm::Instruction>(val);
+    if (llvm::isa<llvm::LoadInst>(I)) {
+        auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(I);
+        auto *argInstr = llvm::dyn_cast<llvm::Instruction>(loadInst->getOperand(0));
+        map[argInstr] = interv;
+    } else {
+        llvm::errs() << "WARNING: only support x > y not x + 1 > y etc\n";
+    }
+}
+
+
+std::pair<Interval, Interval> cmpTransfer(const Interval& left, const Interval& right, const std::string& opName) {
+    if (opName.find("eq") != std::string::npos)
+        return Interval::eqTransfer(left, right);
+
+    if (opName.find("ne") != std::string::npos)
+        return Interval::neTransfer(left, right);
+
+    if (opName.find("lt") != std::string::npos)
+        return Interval::ltTransfer(left, right);
+
+    if (opName.find("le") != std::string::npos)
+        return Interval::leTransfer(left, right);
+
+    if (opName.find("gt") != std::string::npos)
+        return Interval::gtTransfer(left, right);
+
+    if (opName.find("ge") != std::string::npos)
+        return Interval::geTransfer(left, right);
+
+    llvm::errs() << "error in cmpTransfer, opName: " << opName << "\n";
+    return {Interval::empty(), Interval::empty()};
 }
 
 // get BasicBlock Label
@@ -109,5 +375,5 @@ void printInstruction(const llvm::Instruction &I) {
     std::string str;
     llvm::raw_string_ostream ss(str);
     ss << I;
-    llvm::outs() << ss.str() << "\n";
+    llvm::errs() << ss.str() << "\n";
 }
\ No newline at end of file
@@ -10,16 +10,68 @@
 #include "abst.h"
 #include "interval.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "fixpoint.h"
+#include "persistentMap.h"
 
-typedef std::unordered_map<llvm::Instruction*, Interval> instr_interv_map;
+// copies share their nodes, so the state handed to each branch and pushed on the DFS stacks costs O(1)
+typedef PersistentMap<llvm::Instruction*, Interval> instr_interv_map;
+
+struct CmpBrInterval {
+    bool feasible = true; // whether this branch is feasible
+    instr_interv_map interv;
+};
+
+struct CmpIntervals {
+    CmpBrInterval T;
+    CmpBrInterval F;
+};
+
+typedef std::unordered_map<llvm::Instruction*, CmpIntervals> cmp_interv_map;
+
+class ResultWriter;
+
+struct WideningOptions {
+    unsigned delay = 1;           // states joined into a loop head before it is widened
+    bool thresholds = false;      // widen bounds to the constants of the comparisons before infinity
+    unsigned narrowingPasses = 4; // at most
+    // if set, loop heads are joined instead, snapping the bounds beyond +-clamp to infinity (task 3 before widening)
+    long long clamp = 0;
+};
 
 
 Interval extractInterval(llvm::Value *V, instr_interv_map& map);
-void removeReg(instr_interv_map &intervMap);
+void removeReg(instr_interv_map &intervMap, llvm::BasicBlock *BB);
+// union `incoming` into `into` variable by variable, return whether `into` changed
+bool joinIntervals(instr_interv_map &into, const instr_interv_map &incoming);
+// same for widening and narrowing
+bool widenIntervals(instr_interv_map &into, const instr_interv_map &incoming, const std::vector<Abst> &thresholds);
+bool narrowIntervals(instr_interv_map &into, const instr_interv_map &incoming);
+bool clampIntervals(instr_interv_map &map, const Abst &bound);
+// sorted constants the comparisons of `F` are made with, and their neighbours
+std::vector<Abst> wideningThresholds(llvm::Function &F);
 Interval binaryOperation(const Interval& left, const Interval& right, const llvm::Instruction& I);
-void printBBDifference(std::unordered_map<std::string, instr_interv_map> &map);
-void printBBInterval(std::unordered_map<std::string, instr_interv_map> &map);
+void printBBDifference(const std::unordered_map<std::string, instr_interv_map> &map, llvm::raw_ostream &OS = llvm::outs());
+void printBBInterval(const std::unordered_map<std::string, instr_interv_map> &map, llvm::raw_ostream &OS = llvm::outs());
 void printInstruction(const llvm::Instruction &I);
-void printInterval(const instr_interv_map &map);
+std::string getSimpleNodeLabel(const llvm::BasicBlock *Node);
+void printInterval(const instr_interv_map &map, llvm::raw_ostream &OS = llvm::outs());
+// the same through a ResultWriter: a "block" record per block, followed by an "interval" record (var, lo, hi) per
+// variable or a "sep" record (x, y, sep) per pair
+void writeBBInterval(const std::unordered_map<std::string, instr_interv_map> &map, ResultWriter &writer);
+void writeBBDifference(const std::unordered_map<std::string, instr_interv_map> &map, ResultWriter &writer);
+// a finite value as an integer, the others as "inf", "-inf" or "undef"
+void writeAbst(ResultWriter &writer, llvm::StringRef name, const Abst &value);
+// intervals at the exit of every reachable block, optionally refined along the outcomes of conditional branches.
+// Without `widening` the states are only joined, so a loop that does not bound its variables never terminates
+std::unordered_map<std::string, instr_interv_map> intervalFixpoint(llvm::Function &F, bool refineBranches, FixpointStats *stats = nullptr,
+                                                                   const WideningOptions *widening = nullptr);
+// if `cmpIntervMap` is given, the refined intervals for both outcomes of each comparison are recorded in it
+void processBlock(llvm::BasicBlock *BB, instr_interv_map &intervMap, cmp_interv_map *cmpIntervMap = nullptr);
+std::pair<Interval, Interval> cmpTransfer(const Interval& left, const Interval& right, const std::string& opName);
+void updateValueInterval(instr_interv_map &map, llvm::Value *val, const Interval& interv);
+// `map` is a copy sharing the nodes of the block state, only the refined variables are copied
+CmpBrInterval getCmpInterval(instr_interv_map map, llvm::BasicBlock *BB, llvm::Value *left, llvm::Value *right,
+                             const Interval &leftInterv, const Interval &rightInterv);
 
 #endif //A2_UTILS_H
@@ -0,0 +1,667 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "zone.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Format.h"
+#include "resultWriter.h"
+
+Zone::Zone(unsigned vars): n(vars + 1), m(n * n, INF) {
+    for (unsigned i = 0; i < n; ++i)
+        at(i, i) = 0;
+}
+
+long long Zone::add(long long a, long long b) {
+    if (a == INF || b == INF)
+        return INF;
+    long long sum = a + b;
+    return sum > LIMIT ? INF : std::max(sum, -LIMIT);
+}
+
+Interval Zone::interval(unsigned x) const {
+    if (isEmpty())
+        return Interval::empty();
+    Abst lo = bound(0, x) == INF ? Abst::negInf() : Abst(-bound(0, x));
+    Abst hi = bound(x, 0) == INF ? Abst::inf() : Abst(bound(x, 0));
+    if (lo > hi)
+        return Interval::empty();
+    return {lo, hi};
+}
+
+Abst Zone::sep(unsigned x, unsigned y) const {
+    if (isEmpty() || bound(x, y) == INF || bound(y, x) == INF)
+        return Abst::inf();
+    return Abst(std::max(std::abs(bound(x, y)), std::abs(bound(y, x))));
+}
+
+void Zone::close() {
+    if (closed || isEmpty())
+        return;
+    for (unsigned k = 0; k < n; ++k) {
+        const long long *rk = &m[k * n];
+        for (unsigned a = 0; a < n; ++a) {
+            long long ak = at(a, k);
+            if (ak == INF)
+                continue;
+            long long *ra = &m[a * n];
+            for (unsigned b = 0; b < n; ++b) {
+                long long sum = ak + rk[b];
+                sum = rk[b] == INF || sum > LIMIT ? INF : std::max(sum, -LIMIT);
+                ra[b] = std::min(ra[b], sum);
+            }
+        }
+    }
+    for (unsigned i = 0; i < n; ++i)
+        if (at(i, i) < 0)
+            empty = true;
+    closed = true;
+}
+
+void Zone::forget(unsigned x) {
+    close();
+    if (isEmpty())
+        return;
+    for (unsigned k = 0; k < n; ++k)
+        if (k != x)
+            at(x, k) = at(k, x) = INF;
+}
+
+void Zone::assign(unsigned x, unsigned y, long long c) {
+    close();
+    if (isEmpty())
+        return;
+    if (x == y) {
+        for (unsigned k = 0; k < n; ++k)
+            if (k != x) {
+                at(x, k) = add(at(x, k), c);
+                at(k, x) = add(at(k, x), -c);
+            }
+        return;
+    }
+    // x becomes a copy of y shifted by c, which keeps the matrix closed
+    for (unsigned k = 0; k < n; ++k)
+        if (k != x) {
+            at(x, k) = add(c, at(y, k));
+            at(k, x) = add(at(k, y), -c);
+        }
+}
+
+void Zone::assign(unsigned x, const Interval &value) {
+    forget(x);
+    if (isEmpty() || value.isEmpty())
+        return;
+    long long upper = value.upper().isPosInf() ? INF : value.upper().bits();
+    long long negLower = value.lower().isNegInf() ? INF : -value.lower().bits();
+    for (unsigned k = 0; k < n; ++k)
+        if (k != x) {
+            at(x, k) = add(upper, at(0, k));
+            at(k, x) = add(at(k, 0), negLower);
+        }
+}
+
+void Zone::constrain(unsigned i, unsigned j, long long c) {
+    close();
+    if (isEmpty() || c > LIMIT || c >= at(i, j))
+        return;
+    c = std::max(c, -LIMIT);
+    if (add(at(j, i), c) < 0) {
+        empty = true;
+        return;
+    }
+    // the only paths getting shorter go through the new edge i -> j
+    const long long *rj = &m[j * n];
+    for (unsigned a = 0; a < n; ++a) {
+        long long aj = add(at(a, i), c);
+        if (aj == INF)
+            continue;
+        long long *ra = &m[a * n];
+        for (unsigned b = 0; b < n; ++b) {
+            long long sum = aj + rj[b];
+            sum = rj[b] == INF || sum > LIMIT ? INF : std::max(sum, -LIMIT);
+            ra[b] = std::min(ra[b], sum);
+        }
+    }
+}
+
+bool Zone::joinWith(const Zone &other) {
+    if (other.isEmpty())
+        return false;
+    if (isEmpty()) {
+        *this = other;
+        return true;
+    }
+    bool changed = false;
+    for (unsigned i = 0; i < m.size(); ++i)
+        if (other.m[i] > m[i]) {
+            m[i] = other.m[i];
+            changed = true;
+        }
+    closed = closed && other.closed;
+    return changed;
+}
+
+bool Zone::widenWith(const Zone &other, const std::vector<Abst> &thresholds) {
+    if (other.isEmpty())
+        return false;
+    if (isEmpty()) {
+        *this = other;
+        return true;
+    }
+    bool changed = false;
+    for (unsigned i = 0; i < m.size(); ++i)
+        if (other.m[i] > m[i]) {
+            if (i >= n && i % n) {
+                m[i] = INF;
+                changed = true;
+                continue;
+            }
+            auto it = std::lower_bound(thresholds.begin(), thresholds.end(), Abst::fromBits(other.m[i]));
+            m[i] = it == thresholds.end() || it->isInf() ? INF : it->bits();
+            changed = true;
+        }
+    // closing the widened state again would undo the widening
+    closed = closed && !changed;
+    return changed;
+}
+
+bool Zone::narrowWith(const Zone &other) {
+    if (isEmpty() || other.isEmpty())
+        return false;
+    bool changed = false;
+    for (unsigned i = 0; i < m.size(); ++i)
+        if (m[i] == INF && other.m[i] != INF) {
+            m[i] = other.m[i];
+            changed = true;
+        }
+    if (changed) {
+        closed = false;
+        close();
+    }
+    return changed;
+}
+
+bool Zone::operator==(const Zone &other) const {
+    if (isEmpty() || other.isEmpty())
+        return isEmpty() == other.isEmpty() && n == other.n;
+    return m == other.m;
+}
+
+Packing::Packing(llvm::Function &F, const VarSlots &slots, bool pack)
+        : packOf(slots.size() + 1, -1), indexOf(slots.size() + 1, 0) {
+    // union-find over the slots
+    std::vector<unsigned> parent(slots.size());
+    for (unsigned i = 0; i < parent.size(); ++i)
+        parent[i] = i;
+    auto find = [&](unsigned x) {
+        while (parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    auto unite = [&](int x, int y) {
+        if (x >= 0 && y >= 0)
+            parent[find(x)] = find(y);
+    };
+
+    if (pack) {
+        // a variable each register was computed from, the others being in its pack already
+        llvm::DenseMap<const llvm::Value *, int> regs;
+        // the registers holding a variable plus or minus constants
+        llvm::DenseMap<const llvm::Value *, int> shifted;
+        auto varOf = [](const llvm::DenseMap<const llvm::Value *, int> &map, const llvm::Value *V) {
+            auto it = map.find(V);
+            return it == map.end() ? -1 : it->second;
+        };
+        // the blocks where a variable is shifted by a constant, x = x + c
+        std::vector<std::pair<const llvm::BasicBlock *, int>> shifts;
+        for (auto &BB: F)
+            for (auto &I: BB) {
+                if (auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+                    regs[&I] = shifted[&I] = slots.slot(loadInst->getPointerOperand());
+                } else if (auto *storeInst = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+                    int x = slots.slot(storeInst->getPointerOperand());
+                    unite(x, varOf(regs, storeInst->getValueOperand()));
+                    if (x >= 0 && varOf(shifted, storeInst->getValueOperand()) == x)
+                        shifts.emplace_back(&BB, x);
+                } else if (llvm::isa<llvm::BinaryOperator>(I) || llvm::isa<llvm::ICmpInst>(I)) {
+                    int left = varOf(regs, I.getOperand(0)), right = varOf(regs, I.getOperand(1));
+                    unite(left, right);
+                    regs[&I] = left >= 0 ? left : right;
+                    std::string opName = I.getOpcodeName();
+                    if ((opName == "add" || opName == "sub") && llvm::isa<llvm::ConstantInt>(I.getOperand(1)))
+                        shifted[&I] = varOf(shifted, I.getOperand(0));
+                    else if (opName == "add" && llvm::isa<llvm::ConstantInt>(I.getOperand(0)))
+                        shifted[&I] = varOf(shifted, I.getOperand(1));
+                }
+            }
+
+        // variables shifted in the same loop, like the counters of `for (i = 0, j = 10; ...; i++, j++)`, are
+        // related through the iterations although no statement mentions both
+        llvm::DominatorTree DT(F);
+        llvm::LoopInfo LI(DT);
+        for (auto *loop: LI.getLoopsInPreorder()) {
+            int first = -1;
+            for (auto &[BB, x]: shifts)
+                if (loop->contains(BB)) {
+                    unite(x, first);
+                    first = x;
+                }
+        }
+    } else {
+        for (unsigned i = 1; i < parent.size(); ++i)
+            unite(i, 0);
+    }
+
+    std::vector<std::vector<unsigned>> groups(parent.size());
+    for (unsigned i = 0; i < parent.size(); ++i)
+        groups[find(i)].push_back(i + 1);
+    for (auto &group: groups) {
+        if (group.size() == 1) {
+            indexOf[group.front()] = singleCount++;
+        } else if (!group.empty()) {
+            for (unsigned i = 0; i < group.size(); ++i) {
+                packOf[group[i]] = members.size();
+                indexOf[group[i]] = i + 1;
+            }
+            members.push_back(std::move(group));
+        }
+    }
+}
+
+PackedZone::PackedZone(const Packing &packing): packing(&packing), singles(packing.singles()), empty(false) {
+    for (auto &pack: packing.packs())
+        zones.emplace_back(pack.size());
+    for (unsigned i = 0; i < packing.singles(); ++i)
+        singles.set(i, Interval(Abst::negInf(), Abst::inf()));
+}
+
+int PackedZone::sharedPack(unsigned x, unsigned y) const {
+    int px = x ? packing->pack(x) : -1, py = y ? packing->pack(y) : -1;
+    if (!x || !y || px == py)
+        return x ? px : py;
+    return -1;
+}
+
+long long PackedZone::bound(unsigned i, unsigned j) const {
+    int p = sharedPack(i, j);
+    if (p >= 0)
+        return zones[p].bound(local(i), local(j));
+    if (i == j)
+        return 0;
+    // the largest vi - vj
+    Abst hi = i ? interval(i).upper() : Abst(0), lo = j ? interval(j).lower() : Abst(0);
+    if (hi.isPosInf() || lo.isNegInf())
+        return Zone::INF;
+    long long diff = hi.bits() - lo.bits();
+    return diff > Zone::LIMIT ? Zone::INF : std::max(diff, -Zone::LIMIT);
+}
+
+Interval PackedZone::interval(unsigned x) const {
+    if (empty)
+        return Interval::empty();
+    int p = packing->pack(x);
+    return p >= 0 ? zones[p].interval(local(x)) : singles.get(local(x));
+}
+
+Abst PackedZone::sep(unsigned x, unsigned y) const {
+    if (empty)
+        return Abst::inf();
+    int p = sharedPack(x, y);
+    return p >= 0 ? zones[p].sep(local(x), local(y)) : interval(x).sep(interval(y));
+}
+
+void PackedZone::setSingle(unsigned x, const Interval &value) {
+    if (value.isEmpty())
+        empty = true;
+    else
+        singles.set(local(x), value);
+}
+
+void PackedZone::assign(unsigned x, unsigned y, long long c) {
+    if (empty)
+        return;
+    int p = sharedPack(x, y);
+    if (p >= 0 && y)
+        zones[p].assign(local(x), local(y), c);
+    else
+        assign(x, (y ? interval(y) : Interval(Abst(0))) + Interval(Abst(c)));
+}
+
+void PackedZone::assign(unsigned x, const Interval &value) {
+    if (empty)
+        return;
+    int p = packing->pack(x);
+    if (p >= 0)
+        zones[p].assign(local(x), value);
+    else if (value.isEmpty())
+        forget(x);
+    else
+        singles.set(local(x), value);
+}
+
+void PackedZone::forget(unsigned x) {
+    if (empty)
+        return;
+    int p = packing->pack(x);
+    if (p >= 0)
+        zones[p].forget(local(x));
+    else
+        singles.set(local(x), Interval(Abst::negInf(), Abst::inf()));
+}
+
+void PackedZone::constrain(unsigned i, unsigned j, long long c) {
+    if (empty || (!i && !j))
+        return;
+    int p = sharedPack(i, j);
+    if (p >= 0) {
+        zones[p].constrain(local(i), local(j), c);
+        empty = zones[p].isEmpty();
+        return;
+    }
+    if (!j || !i) {
+        // a single variable alone: vi <= c, or -vj <= c
+        unsigned x = i ? i : j;
+        Interval value = singles.get(local(x));
+        Abst lo = value.lower(), hi = value.upper();
+        if (i)
+            hi = std::min(hi, Abst(c));
+        else
+            lo = std::max(lo, Abst(-c));
+        setSingle(x, value.isEmpty() || lo > hi ? Interval::empty() : Interval(lo, hi));
+        return;
+    }
+    // different packs: vi <= c + max vj and -vj <= c - min vi
+    Interval vi = interval(i), vj = interval(j);
+    if (!vj.upper().isPosInf())
+        constrain(i, 0, c + vj.upper().bits());
+    if (!vi.lower().isNegInf())
+        constrain(0, j, c - vi.lower().bits());
+}
+
+bool PackedZone::joinWith(const PackedZone &other) {
+    if (other.empty)
+        return false;
+    if (empty) {
+        *this = other;
+        return true;
+    }
+    bool changed = singles.joinWith(other.singles);
+    for (unsigned p = 0; p < zones.size(); ++p)
+        changed |= zones[p].joinWith(other.zones[p]);
+    return changed;
+}
+
+bool PackedZone::widenWith(const PackedZone &other, const std::vector<Abst> &thresholds) {
+    if (other.empty)
+        return false;
+    if (empty) {
+        *this = other;
+        return true;
+    }
+    bool changed = singles.widenWith(other.singles, thresholds);
+    for (unsigned p = 0; p < zones.size(); ++p)
+        changed |= zones[p].widenWith(other.zones[p], thresholds);
+    return changed;
+}
+
+bool PackedZone::narrowWith(const PackedZone &other) {
+    if (empty || other.empty)
+        return false;
+    bool changed = singles.narrowWith(other.singles);
+    for (unsigned p = 0; p < zones.size(); ++p)
+        changed |= zones[p].narrowWith(other.zones[p]);
+    return changed;
+}
+
+bool PackedZone::operator==(const PackedZone &other) const {
+    if (empty || other.empty)
+        return empty == other.empty;
+    return singles == other.singles && zones == other.zones;
+}
+
+size_t PackedZone::bounds() const {
+    size_t count = 2 * singles.size();
+    for (const Zone &zone: zones)
+        count += (zone.size() + 1) * (zone.size() + 1);
+    return count;
+}
+
+
+namespace {
+// a register as a variable (0 for none, the constant 0) plus an offset
+struct Operand {
+    unsigned var = 0;
+    Interval offset;
+};
+}
+
+static Interval valueOf(const PackedZone &zone, const Operand &op) {
+    return op.var ? zone.interval(op.var) + op.offset : op.offset;
+}
+
+// the transfer of a block on a zone. If the block ends with a conditional branch on one of its comparisons, the
+// states along the true and false outcomes are put in `branches`, empty if infeasible, and true is returned
+static bool processBlock(llvm::BasicBlock *BB, PackedZone &zone, const VarSlots &slots, PackedZone *branches) {
+    llvm::DenseMap<const llvm::Value *, Operand> regs;
+    const Interval top(Abst::negInf(), Abst::inf());
+    auto operand = [&](llvm::Value *V) {
+        if (auto *constInstr = llvm::dyn_cast<llvm::ConstantInt>(V)) {
+            long long val = constInstr->getSExtValue();
+            return Operand{0, Interval(val)};
+        }
+        auto it = regs.find(V);
+        return it == regs.end() ? Operand{0, top} : it->second;
+    };
+    auto *br = llvm::dyn_cast<llvm::BranchInst>(BB->getTerminator());
+    const llvm::Value *condition = br && br->isConditional() ? br->getCondition() : nullptr;
+    bool refined = false;
+
+    for (auto &I: *BB) {
+        if (llvm::isa<llvm::AllocaInst>(I)) {
+            zone.forget(slots.slot(&I) + 1);
+        }
+        else if (auto *loadInst = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+            int var = slots.slot(loadInst->getPointerOperand());
+            regs[&I] = var >= 0 ? Operand{unsigned(var) + 1, Interval(0)} : Operand{0, top};
+        }
+        else if (auto *storeInst = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+            int slot = slots.slot(storeInst->getPointerOperand());
+            if (slot < 0)
+                continue;
+            unsigned x = slot + 1;
+            Operand value = operand(storeInst->getValueOperand());
+            // registers loaded from x keep the old value
+            for (auto &reg: regs)
+                if (reg.second.var == x)
+                    reg.second = Operand{0, valueOf(zone, reg.second)};
+            Interval offset = value.offset;
+            bool exact = !offset.isEmpty() && offset.lower() == offset.upper() && !offset.lower().isInf();
+            // x := x + c shifts x, any other update of x from itself loses the relation
+            if (value.var == x && !exact)
+                value = Operand{0, valueOf(zone, value)};
+            if (value.var && exact) {
+                zone.assign(x, value.var, offset.lower().bits());
+            } else if (value.var && !offset.isEmpty()) {
+                zone.assign(x, valueOf(zone, value));
+                if (!offset.upper().isInf())
+                    zone.constrain(x, value.var, offset.upper().bits());
+                if (!offset.lower().isInf())
+                    zone.constrain(value.var, x, -offset.lower().bits());
+            } else {
+                zone.assign(x, offset);
+            }
+        }
+        else if (llvm::isa<llvm::BinaryOperator>(I)) {
+            Operand left = operand(I.getOperand(0)), right = operand(I.getOperand(1));
+            std::string opName = I.getOpcodeName();
+            Operand result;
+            if (opName == "add" && (!left.var || !right.var))
+                result = Operand{left.var + right.var, left.offset + right.offset};
+            else if (opName == "sub" && !right.var)
+                result = Operand{left.var, left.offset - right.offset};
+            else if (opName == "sub" && left.var) {
+                // the difference of two variables is bounded by the zone
+                Abst lo = left.var == right.var ? Abst(0) : zone.bound(right.var, left.var) == Zone::INF
+                          ? Abst::negInf() : Abst(-zone.bound(right.var, left.var));
+                Abst hi = left.var == right.var ? Abst(0) : zone.bound(left.var, right.var) == Zone::INF
+                          ? Abst::inf() : Abst(zone.bound(left.var, right.var));
+                result.offset = lo > hi ? Interval::empty() : Interval(lo, hi) + left.offset - right.offset;
+            } else
+                result.offset = binaryOperation(valueOf(zone, left), valueOf(zone, right), I);
+            regs[&I] = result;
+        }
+        else if (&I == condition && llvm::isa<llvm::ICmpInst>(I)) {
+            refined = true;
+            auto *cmpInst = llvm::dyn_cast<llvm::CmpInst>(&I);
+            Operand left = operand(I.getOperand(0)), right = operand(I.getOperand(1));
+            llvm::CmpInst::Predicate preds[2] = {cmpInst->getPredicate(), cmpInst->getInversePredicate()};
+            for (unsigned outcome = 0; outcome < 2; ++outcome) {
+                PackedZone &refined = branches[outcome];
+                refined = zone;
+                // one - other <= d, for the variables plus the worst case of the offsets
+                auto constrain = [&](const Operand &one, const Operand &other, long long d) {
+                    if (one.offset.isEmpty() || other.offset.isEmpty() || one.offset.lower().isInf()
+                        || other.offset.upper().isInf())
+                        return;
+                    refined.constrain(one.var, other.var, d - one.offset.lower().bits() + other.offset.upper().bits());
+                };
+                switch (preds[outcome]) {
+                    case llvm::CmpInst::ICMP_SLT:
+                    case llvm::CmpInst::ICMP_ULT:
+                        constrain(left, right, -1);
+                        break;
+                    case llvm::CmpInst::ICMP_SLE:
+                    case llvm::CmpInst::ICMP_ULE:
+                        constrain(left, right, 0);
+                        break;
+                    case llvm::CmpInst::ICMP_SGT:
+                    case llvm::CmpInst::ICMP_UGT:
+                        constrain(right, left, -1);
+                        break;
+                    case llvm::CmpInst::ICMP_SGE:
+                    case llvm::CmpInst::ICMP_UGE:
+                        constrain(right, left, 0);
+                        break;
+                    case llvm::CmpInst::ICMP_EQ:
+                        constrain(left, right, 0);
+                        constrain(right, left, 0);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+    return refined;
+}
+
+std::unordered_map<std::string, PackedZone> zoneFixpoint(llvm::Function &F, const VarSlots &slots, const Packing &packing,
+                                                         FixpointStats *stats, const WideningOptions *widening) {
+    Fixpoint<PackedZone> fixpoint(F, Direction::Forward);
+    Fixpoint<PackedZone>::join_fn join =
+            [](PackedZone &into, const PackedZone &incoming) { return into.joinWith(incoming); };
+    Fixpoint<PackedZone>::join_fn widen;
+    if (widening) {
+        // upper bounds stop at the constants, lower bounds (negated) at their opposites
+        std::vector<Abst> thresholds;
+        if (widening->thresholds)
+            for (const Abst &t: wideningThresholds(F))
+                thresholds.insert(thresholds.end(), {t, -t});
+        std::sort(thresholds.begin(), thresholds.end());
+        widen = [thresholds](PackedZone &into, const PackedZone &incoming) {
+            return into.widenWith(incoming, thresholds);
+        };
+    }
+    Fixpoint<PackedZone>::transfer_fn transfer =
+            [&slots](llvm::BasicBlock *BB, PackedZone &zone, const Fixpoint<PackedZone>::emit_fn &emit) {
+            PackedZone branches[2];
+            if (processBlock(BB, zone, slots, branches)) {
+                auto *br = llvm::dyn_cast<llvm::BranchInst>(BB->getTerminator());
+                for (unsigned outcome = 0; outcome < 2; ++outcome)
+                    if (!branches[outcome].isEmpty())
+                        emit(br->getSuccessor(outcome), branches[outcome]);
+            } else if (!zone.isEmpty()) {
+                for (auto suc: llvm::successors(BB))
+                    emit(suc, zone);
+            }
+        };
+    fixpoint.run(PackedZone(packing), transfer, join, widen, widening ? widening->delay : 0);
+    if (widening)
+        fixpoint.descend(PackedZone(packing), transfer, join,
+                         [](PackedZone &into, const PackedZone &incoming) { return into.narrowWith(incoming); },
+                         widening->narrowingPasses);
+
+    if (stats)
+        *stats = fixpoint.stats();
+
+    std::unordered_map<std::string, PackedZone> BBZone;
+    for (auto BB: fixpoint.blocks())
+        if (fixpoint.reached(BB))
+            BBZone[getSimpleNodeLabel(BB)] = fixpoint.out(BB);
+    return BBZone;
+}
+
+void printBBZone(const std::unordered_map<std::string, PackedZone> &map, const VarSlots &slots,
+                 llvm::raw_ostream &OS) {
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        if (it != map.cbegin())
+            OS << "\n";
+        OS << it->first << ":\n";
+        for (unsigned x = 0; x < slots.size(); ++x) {
+            std::string var1 = slots.var(x)->getName();
+            if (var1 == "retval")
+                continue;
+            for (unsigned y = x + 1; y < slots.size(); ++y) {
+                std::string var2 = slots.var(y)->getName();
+                if (var2 == "retval")
+                    continue;
+                OS << "sep(" << var1 << ", " << var2 << ") = " << it->second.sep(x + 1, y + 1) << "\n";
+            }
+        }
+    }
+}
+
+void writeBBZone(const std::unordered_map<std::string, PackedZone> &map, const VarSlots &slots, ResultWriter &writer) {
+    // looked up once, a name is not stored in the value
+    std::vector<std::pair<unsigned, llvm::StringRef>> vars;
+    for (unsigned x = 0; x < slots.size(); ++x)
+        if (slots.var(x)->getName() != "retval")
+            vars.emplace_back(x + 1, slots.var(x)->getName());
+    for (auto &[blockName, zone]: map) {
+        writer.record("block", "name", blockName);
+        for (auto one = vars.begin(); one != vars.end(); ++one)
+            for (auto other = std::next(one); other != vars.end(); ++other) {
+                writer.begin("sep");
+                writer.field("x", one->second);
+                writer.field("y", other->second);
+                writeAbst(writer, "sep", zone.sep(one->first, other->first));
+                writer.end();
+            }
+    }
+}
+
+void reportPacking(llvm::Function &F, const VarSlots &slots, const Packing &packing, const WideningOptions *widening,
+                   llvm::raw_ostream &OS) {
+    Packing single(F, slots, false);
+    double ms[2];
+    const Packing *runs[2] = {&packing, &single};
+    for (unsigned run = 0; run < 2; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        zoneFixpoint(F, slots, *runs[run], nullptr, widening);
+        ms[run] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // in one write, functions are analysed concurrently
+    std::string report, name = F.getName();
+    llvm::raw_string_ostream reportOS(report);
+    reportOS << name << ": " << packing.size() << " variables, " << packing.packs().size() << " packs, "
+             << packing.singles() << " alone\npack sizes:";
+    for (auto &pack: packing.packs())
+        reportOS << " " << pack.size();
+    reportOS << llvm::format("\n%.2f ms with the packs, %.2f ms with a single zone\n", ms[0], ms[1]);
+    OS << reportOS.str();
+}
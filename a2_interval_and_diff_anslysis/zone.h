@@ -0,0 +1,171 @@
+#ifndef A2_ZONE_H
+#define A2_ZONE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "abst.h"
+#include "interval.h"
+#include "intervalState.h"
+#include "utils.h"
+
+/*
+ * Zone domain: a difference bound matrix over the variables v1..vn and the constant v0 = 0, where the entry
+ * (i, j) bounds vi - vj from above, so (x, 0) is the upper bound of x and (0, x) its lower bound negated.
+ * The matrix is one row-major array of n + 1 rows.
+ *
+ * The matrix is kept closed (every entry is the tightest bound the others imply), so a bound is read off in
+ * O(1). Assignments keep it closed in O(n) and a guard in O(n^2), as a new constraint only tightens the paths
+ * going through it; the O(n^3) Floyd-Warshall closure only runs on the states widening leaves open.
+ *
+ * Bounds are long long, INF standing for no bound. Finite bounds are kept within +-LIMIT so that the sums
+ * of the closure cannot overflow, a bound past it is loosened (to INF when above).
+ */
+class Zone {
+public:
+    static constexpr long long INF = Abst::INF;
+    static constexpr long long LIMIT = INF / 2;
+
+    // bottom, the state of a block not reached yet
+    Zone() = default;
+    // no constraint on `vars` variables
+    explicit Zone(unsigned vars);
+
+    [[nodiscard]] unsigned size() const { return n ? n - 1 : 0; }
+    // no value satisfies the constraints
+    [[nodiscard]] bool isEmpty() const { return n == 0 || empty; }
+    // the variables are numbered from 1, 0 is the constant 0
+    [[nodiscard]] long long bound(unsigned i, unsigned j) const { return m[i * n + j]; }
+    [[nodiscard]] Interval interval(unsigned x) const;
+    // the largest |x - y|, see Interval::sep
+    [[nodiscard]] Abst sep(unsigned x, unsigned y) const;
+
+    // x := y + c
+    void assign(unsigned x, unsigned y, long long c);
+    // x := a value in `value`, unrelated to the other variables
+    void assign(unsigned x, const Interval &value);
+    void forget(unsigned x);
+    // add the constraint vi - vj <= c
+    void constrain(unsigned i, unsigned j, long long c);
+
+    // the following return whether the state changed
+    bool joinWith(const Zone &other);
+    // bounds of a variable that grew go to the next of the sorted `thresholds` above them, or to INF, as do
+    // differences that grew
+    bool widenWith(const Zone &other, const std::vector<Abst> &thresholds = {});
+    // INF bounds take those of `other`
+    bool narrowWith(const Zone &other);
+
+    bool operator==(const Zone &other) const;
+    bool operator!=(const Zone &other) const { return !(*this == other); }
+
+private:
+    unsigned n = 0;
+    std::vector<long long> m;
+    bool empty = false;
+    // false after widening, until the next operation closes it
+    bool closed = true;
+
+    long long &at(unsigned i, unsigned j) { return m[i * n + j]; }
+    static long long add(long long a, long long b);
+    void close();
+};
+
+/*
+ * Packs of the variables of a function: two variables end up in the same pack when a value computed from one
+ * is combined with the other in a binary operation, compared with it, or stored into it, directly or through a
+ * chain of those. Only those can get a bound on their difference other than the one their intervals give.
+ *
+ * Every pack of two or more variables gets a zone of its own, and the variables alone in their pack an interval,
+ * so the closures cost O(k^3) in the size k of the largest pack instead of the number of variables.
+ */
+class Packing {
+public:
+    // packs of the variables numbered as in `slots`, or a single pack with all of them if not `pack`
+    Packing(llvm::Function &F, const VarSlots &slots, bool pack = true);
+
+    [[nodiscard]] unsigned size() const { return packOf.size() - 1; }
+    // the packs of two or more variables, each sorted
+    [[nodiscard]] const std::vector<std::vector<unsigned>> &packs() const { return members; }
+    [[nodiscard]] unsigned singles() const { return singleCount; }
+    // -1 if `x` is alone
+    [[nodiscard]] int pack(unsigned x) const { return packOf[x]; }
+    // the number of `x` in the zone of its pack (from 1), or its slot among the variables alone
+    [[nodiscard]] unsigned index(unsigned x) const { return indexOf[x]; }
+
+private:
+    // indexed by variable, from 1 as in the zones
+    std::vector<int> packOf;
+    std::vector<unsigned> indexOf;
+    std::vector<std::vector<unsigned>> members;
+    unsigned singleCount = 0;
+};
+
+/*
+ * The state of the difference analysis with packing: a zone per pack and an IntervalState for the variables
+ * alone, addressed with the numbers of the variables in the whole function, as a single Zone would be. The
+ * difference of variables from different packs is bounded by their intervals.
+ */
+class PackedZone {
+public:
+    // bottom
+    PackedZone() = default;
+    // no constraint on the variables of `packing`, which must outlive the state
+    explicit PackedZone(const Packing &packing);
+
+    [[nodiscard]] bool isEmpty() const { return empty; }
+    [[nodiscard]] long long bound(unsigned i, unsigned j) const;
+    [[nodiscard]] Interval interval(unsigned x) const;
+    [[nodiscard]] Abst sep(unsigned x, unsigned y) const;
+
+    // see Zone
+    void assign(unsigned x, unsigned y, long long c);
+    void assign(unsigned x, const Interval &value);
+    void forget(unsigned x);
+    void constrain(unsigned i, unsigned j, long long c);
+
+    bool joinWith(const PackedZone &other);
+    bool widenWith(const PackedZone &other, const std::vector<Abst> &thresholds = {});
+    bool narrowWith(const PackedZone &other);
+
+    bool operator==(const PackedZone &other) const;
+    bool operator!=(const PackedZone &other) const { return !(*this == other); }
+
+    // the number of bounds held, the matrices of the zones and two per variable alone
+    [[nodiscard]] size_t bounds() const;
+
+private:
+    const Packing *packing = nullptr;
+    std::vector<Zone> zones;
+    IntervalState singles;
+    bool empty = true;
+
+    // x and y in the same zone, or one of them the constant
+    [[nodiscard]] int sharedPack(unsigned x, unsigned y) const;
+    [[nodiscard]] unsigned local(unsigned x) const { return x ? packing->index(x) : 0; }
+    void setSingle(unsigned x, const Interval &value);
+};
+
+// the size of the state in the fixpoint statistics
+inline unsigned long long stateSize(const PackedZone &zone) { return zone.bounds(); }
+
+// zones at the exit of every reachable block, for the variables (allocas) numbered as in `slots`, from 1, and
+// packed as in `packing`. Comparisons between variables, or a variable and a constant, refine the state along
+// each outcome of a branch
+std::unordered_map<std::string, PackedZone> zoneFixpoint(llvm::Function &F, const VarSlots &slots, const Packing &packing,
+                                                         FixpointStats *stats = nullptr,
+                                                         const WideningOptions *widening = nullptr);
+// sep of every pair of variables read from the zones, in the format of printBBDifference
+void printBBZone(const std::unordered_map<std::string, PackedZone> &map, const VarSlots &slots,
+                 llvm::raw_ostream &OS = llvm::outs());
+// the same as writeBBDifference
+void writeBBZone(const std::unordered_map<std::string, PackedZone> &map, const VarSlots &slots, ResultWriter &writer);
+// the sizes of the packs, and the time the analysis takes with them and with a single zone, for --pack-stats
+void reportPacking(llvm::Function &F, const VarSlots &slots, const Packing &packing, const WideningOptions *widening,
+                   llvm::raw_ostream &OS = llvm::errs());
+
+#endif //A2_ZONE_H
@@ -0,0 +1,79 @@
+#include "zone.h"
+#include <iostream>
+
+// the interval of every variable, then the sep of every pair
+static void print(const char *name, const Zone &zone) {
+    std::cout << name << ":";
+    if (zone.isEmpty()) {
+        std::cout << " empty" << std::endl;
+        return;
+    }
+    for (unsigned x = 1; x <= zone.size(); ++x)
+        std::cout << " v" << x << " " << zone.interval(x);
+    for (unsigned x = 1; x <= zone.size(); ++x)
+        for (unsigned y = x + 1; y <= zone.size(); ++y)
+            std::cout << ", sep(v" << x << ", v" << y << ") " << zone.sep(x, y);
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << "=== assignment ===" << std::endl;
+    Zone zone(3);
+    print("top", zone);
+    zone.assign(1, Interval(0, 10));
+    print("v1 := [0, 10]", zone);
+    zone.assign(2, 1, 5);
+    print("v2 := v1 + 5", zone);
+    zone.assign(1, 1, 1);
+    print("v1 := v1 + 1", zone);
+    zone.assign(3, Interval(-3, 3));
+    print("v3 := [-3, 3]", zone);
+    zone.forget(2);
+    print("forget v2", zone);
+
+    std::cout << std::endl;
+    std::cout << "=== guards ===" << std::endl;
+    Zone guarded(3);
+    guarded.constrain(1, 2, 0);
+    print("v1 <= v2", guarded);
+    guarded.constrain(2, 3, -1);
+    print("v2 < v3", guarded);
+    guarded.constrain(3, 0, 10);
+    print("v3 <= 10", guarded);
+    guarded.constrain(0, 1, 0);
+    print("v1 >= 0", guarded);
+    Zone infeasible = guarded;
+    infeasible.constrain(3, 1, 0);
+    print("v3 <= v1", infeasible);
+
+    std::cout << std::endl;
+    std::cout << "=== join, widening and narrowing ===" << std::endl;
+    // i = 0, j = 10 and one iteration of i++, j++
+    Zone first(2), second(2);
+    first.assign(1, Interval(0));
+    first.assign(2, Interval(10));
+    second.assign(1, Interval(1));
+    second.assign(2, 1, 10);
+    print("first", first);
+    print("second", second);
+    Zone joined = first;
+    std::cout << "join changed " << joined.joinWith(second) << std::endl;
+    print("joined", joined);
+    std::cout << "join again changed " << joined.joinWith(second) << std::endl;
+    Zone widened = first;
+    widened.widenWith(second);
+    print("widened", widened);
+    Zone thresholds = first;
+    thresholds.widenWith(second, {-100, 100});
+    print("widened with thresholds", thresholds);
+    // the loop guard i <= 100 on the widened state
+    Zone bounded = widened;
+    bounded.constrain(1, 0, 100);
+    bounded.assign(2, 1, 10);
+    std::cout << "narrow changed " << widened.narrowWith(bounded) << std::endl;
+    print("narrowed", widened);
+    std::cout << "bottom " << (Zone() == Zone() ? "==" : "!=") << " bottom, widened "
+              << (widened == first ? "==" : "!=") << " first" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "cfgGen.h"
+
+/*
+ * End to end benchmarks of the task binaries on generated functions (cfgGen.h). Every sweep varies one parameter
+ * of the base shape, a function is generated for every value and every binary analyses it with `--stats` in a
+ * process of its own, its output going to /dev/null. A row of tab separated values is written per run:
+ *     binary  sweep  value  blocks  visits  ms  rss_kb  status
+ * `visits` is the number of blocks the fixpoint engine visited, `ms` the wall time, `rss_kb` the peak resident
+ * memory of the process, and `status` is `ok`, `timeout`, `exit N` or `signal N`. A run is killed after
+ * `--timeout` seconds, so an analysis blowing up on some shape shows as a timeout rather than a hung suite.
+ *
+ * With `--compare`, the rows are checked against those of an earlier run, and the runs that got slower or visit
+ * more blocks by more than `--threshold`, or stopped finishing, are listed on stderr, the exit code then being 1.
+ */
+
+static llvm::cl::list<std::string> Binaries("bin", llvm::cl::desc("Binary to run, with its options, e.g. \"../a2_interval_and_diff_anslysis/task3_diff --no-packing\" "
+                                                                  "(default: task4, task5, task3_interval and task3_diff)"));
+static llvm::cl::list<std::string> Sweeps("sweep", llvm::cl::desc("Parameter and its values, e.g. vars=8,16,32 (default: vars, statements, "
+                                                                  "depth, sources and expr)"));
+static llvm::cl::opt<std::string> Base("base", llvm::cl::desc("Shape the sweeps start from, as in genCFG --shape"),
+                                       llvm::cl::init("statements=200"));
+static llvm::cl::opt<unsigned> Timeout("timeout", llvm::cl::desc("Seconds before a run is killed"), llvm::cl::init(60));
+static llvm::cl::opt<unsigned> Runs("runs", llvm::cl::desc("Runs of every binary on every input, the fastest one is kept"),
+                                    llvm::cl::init(1));
+static llvm::cl::opt<std::string> Inputs("inputs", llvm::cl::desc("Directory keeping the generated inputs (default: a temporary one)"));
+static llvm::cl::opt<std::string> Output("o", llvm::cl::desc("Output file (default: stdout)"), llvm::cl::value_desc("file"));
+static llvm::cl::opt<std::string> Compare("compare", llvm::cl::desc("Results of an earlier run to check these against"));
+static llvm::cl::opt<double> Threshold("threshold", llvm::cl::desc("Ratio of time or visits to an earlier run reported as a regression"),
+                                       llvm::cl::init(1.5));
+
+static const char *const DefaultBinaries[] = {"../a1_taint_and_VB_analysis/task4", "../a1_taint_and_VB_analysis/task5",
+                                              "../a2_interval_and_diff_anslysis/task3_interval",
+                                              "../a2_interval_and_diff_anslysis/task3_diff"};
+static const char *const DefaultSweeps[] = {"vars=8,16,32,64,128", "statements=100,200,400,800,1600", "depth=1,2,3,4",
+                                            "sources=1,4,16", "expr=1,2,4"};
+// times below this are mostly process start up, too noisy to compare
+static const double MinComparedMs = 20;
+
+struct Result {
+    unsigned long long visits = 0;
+    double ms = 0;
+    long rssKB = 0;
+    std::string status = "ok";
+};
+
+// run `command` on `input` with --stats, killing it after --timeout seconds
+static Result run(const std::string &command, llvm::StringRef input, llvm::StringRef statsFile) {
+    llvm::SmallVector<llvm::StringRef, 8> words;
+    llvm::StringRef(command).split(words, ' ', -1, false);
+    std::vector<std::string> args(words.begin(), words.end());
+    args.push_back("--stats");
+    args.push_back(input.str());
+    std::vector<char *> argv;
+    for (auto &arg: args)
+        argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+    std::string statsPath = statsFile.str();
+
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int out = open("/dev/null", O_WRONLY), err = open(statsPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        dup2(out, STDOUT_FILENO);
+        dup2(err, STDERR_FILENO);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    if (pid < 0) {
+        result.status = "fork failed";
+        return result;
+    }
+
+    // poll rather than block, so the time limit holds; a millisecond is below the noise of a process start
+    auto deadline = start + std::chrono::seconds(Timeout);
+    int status = 0;
+    struct rusage usage = {};
+    bool killed = false;
+    while (wait4(pid, &status, WNOHANG, &usage) == 0) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            kill(pid, SIGKILL);
+            wait4(pid, &status, 0, &usage);
+            killed = true;
+            break;
+        }
+        usleep(1000);
+    }
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.rssKB = usage.ru_maxrss;
+    if (killed)
+        result.status = "timeout";
+    else if (WIFSIGNALED(status))
+        result.status = "signal " + std::to_string(WTERMSIG(status));
+    else if (WEXITSTATUS(status))
+        result.status = "exit " + std::to_string(WEXITSTATUS(status));
+
+    // "stats: N block visits in Xs"
+    if (auto stats = llvm::MemoryBuffer::getFile(statsFile)) {
+        llvm::StringRef text = (*stats)->getBuffer();
+        size_t at = text.rfind("stats: ");
+        if (at != llvm::StringRef::npos)
+            text.substr(at + 7).split(' ').first.getAsInteger(10, result.visits);
+    }
+    return result;
+}
+
+typedef std::map<std::string, std::vector<std::string>> results;
+
+// the fields of the rows of an earlier run by binary, sweep and value
+static results readResults(const std::string &path) {
+    results rows;
+    auto file = llvm::MemoryBuffer::getFile(path);
+    if (!file) {
+        llvm::errs() << "error: failed to read \"" << path << "\"\n";
+        return rows;
+    }
+    for (llvm::line_iterator line(**file); !line.is_at_eof(); ++line) {
+        llvm::SmallVector<llvm::StringRef, 8> fields;
+        line->split(fields, '\t');
+        if (fields.size() == 8 && fields[0] != "binary")
+            rows[(fields[0] + "\t" + fields[1] + "\t" + fields[2]).str()] = std::vector<std::string>(fields.begin(), fields.end());
+    }
+    return rows;
+}
+
+int main(int argc, char **argv) {
+    llvm::cl::ParseCommandLineOptions(argc, argv, "end to end benchmarks on generated functions\n");
+    CFGShape base;
+    if (!parseShape(base, Base)) {
+        llvm::errs() << "error: invalid shape \"" << Base << "\"\n";
+        return 1;
+    }
+    std::vector<std::string> binaries(Binaries.begin(), Binaries.end()), sweeps(Sweeps.begin(), Sweeps.end());
+    if (binaries.empty())
+        binaries.assign(std::begin(DefaultBinaries), std::end(DefaultBinaries));
+    if (sweeps.empty())
+        sweeps.assign(std::begin(DefaultSweeps), std::end(DefaultSweeps));
+    for (auto &binary: binaries)
+        if (!llvm::sys::fs::can_execute(llvm::StringRef(binary).split(' ').first))
+            llvm::errs() << "warning: cannot run \"" << binary << "\", build it first\n";
+
+    llvm::SmallString<128> dir(Inputs);
+    if (dir.empty()) {
+        if (std::error_code EC = llvm::sys::fs::createUniqueDirectory("benchSuite", dir)) {
+            llvm::errs() << "error: failed to create a temporary directory: " << EC.message() << "\n";
+            return 1;
+        }
+    } else {
+        llvm::sys::fs::create_directories(dir);
+    }
+    llvm::SmallString<128> statsFile(dir);
+    llvm::sys::path::append(statsFile, "stats.txt");
+
+    std::error_code EC;
+    llvm::raw_fd_ostream file(Output.empty() ? std::string("-") : Output, EC, llvm::sys::fs::F_Text);
+    if (EC) {
+        llvm::errs() << "error: cannot write \"" << Output << "\": " << EC.message() << "\n";
+        return 1;
+    }
+    results old = Compare.empty() ? results() : readResults(Compare);
+    unsigned regressions = 0;
+
+    file << "binary\tsweep\tvalue\tblocks\tvisits\tms\trss_kb\tstatus\n";
+    for (auto &sweep: sweeps) {
+        auto keyValues = llvm::StringRef(sweep).split('=');
+        llvm::SmallVector<llvm::StringRef, 8> values;
+        keyValues.second.split(values, ',', -1, false);
+        for (llvm::StringRef value: values) {
+            CFGShape shape = base;
+            if (!setShapeParam(shape, keyValues.first, value)) {
+                llvm::errs() << "error: invalid shape \"" << keyValues.first << "=" << value << "\" in sweep \"" << sweep
+                             << "\"\n";
+                return 1;
+            }
+            llvm::LLVMContext Context;
+            llvm::Module M("generated", Context);
+            size_t blocks = CFGGenerator(M, shape).generate("main")->size();
+            llvm::SmallString<128> input(dir);
+            llvm::sys::path::append(input, (keyValues.first + "-" + value + ".ll").str());
+            {
+                llvm::raw_fd_ostream IR(input, EC, llvm::sys::fs::F_Text);
+                M.print(IR, nullptr);
+            }
+
+            for (auto &binary: binaries) {
+                Result best;
+                for (unsigned i = 0; i < std::max(1u, unsigned(Runs)); ++i) {
+                    Result result = run(binary, input, statsFile);
+                    if (i == 0 || result.ms < best.ms)
+                        best = result;
+                    if (result.status != "ok")
+                        break;
+                }
+                std::string key = binary + "\t" + keyValues.first.str() + "\t" + value.str();
+                file << key << "\t" << blocks << "\t" << best.visits << "\t" << llvm::format("%.1f", best.ms) << "\t"
+                     << best.rssKB << "\t" << best.status << "\n";
+                file.flush();
+
+                auto it = old.find(key);
+                if (it == old.end())
+                    continue;
+                const auto &before = it->second;
+                unsigned long long oldVisits = 0;
+                double oldMs = 0;
+                llvm::StringRef(before[4]).getAsInteger(10, oldVisits);
+                llvm::StringRef(before[5]).getAsDouble(oldMs);
+                std::string why;
+                llvm::raw_string_ostream whyOS(why);
+                if (before[7] == "ok" && best.status != "ok")
+                    whyOS << best.status;
+                else if (oldVisits && best.visits > Threshold * oldVisits)
+                    whyOS << oldVisits << " -> " << best.visits << " visits";
+                else if (best.ms > MinComparedMs && best.ms > Threshold * oldMs)
+                    whyOS << llvm::format("%.1f -> %.1f ms", oldMs, best.ms);
+                if (!whyOS.str().empty()) {
+                    ++regressions;
+                    llvm::errs() << "regression: " << binary << " on " << keyValues.first << "=" << value << ": " << why << "\n";
+                }
+            }
+        }
+    }
+    llvm::sys::fs::remove(statsFile);
+    if (Inputs.empty())
+        llvm::sys::fs::remove_directories(dir);
+    if (!Compare.empty())
+        llvm::errs() << regressions << " regressions against " << Compare << "\n";
+    return regressions ? 1 : 0;
+}
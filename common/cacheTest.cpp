@@ -0,0 +1,62 @@
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "driver.h"
+
+/*
+ * Runs that only differ in the options of the driver share their cache entries, whatever the spelling of the
+ * options, and runs with other analysis options do not:
+ *     ./compile cacheTest.cpp && ./cacheTest
+ */
+
+// the salt of a run of the analysis with `args` on in.ll
+static std::string salt(std::vector<const char *> args) {
+    args.insert(args.begin(), "task");
+    args.push_back("in.ll");
+    return cacheSalt(int(args.size()), const_cast<char **>(args.data()));
+}
+
+// whether a result stored by the first run is found by the second one
+static bool hit(const std::string &dir, const std::vector<const char *> &first, const std::vector<const char *> &second) {
+    ResultCache(dir, 1 << 20, salt(first)).store("main", "result");
+    std::string result;
+    bool found = ResultCache(dir, 1 << 20, salt(second)).lookup("main", result) && result == "result";
+    ResultCache(dir, 0, "").trim();
+    return found;
+}
+
+int main() {
+    const char *argv[] = {"cacheTest", "in.ll"};
+    llvm::cl::ParseCommandLineOptions(2, argv);
+    llvm::SmallString<128> dir;
+    if (std::error_code EC = llvm::sys::fs::createUniqueDirectory("cacheTest", dir)) {
+        llvm::errs() << "error: failed to create a temporary directory: " << EC.message() << "\n";
+        return 1;
+    }
+
+    struct Case {
+        const char *name;
+        std::vector<const char *> first, second;
+        bool hit;
+    };
+    std::vector<Case> cases = {
+            {"-jobs 2, then -jobs 4", {"-jobs", "2", "-var=sink"}, {"-jobs", "4", "-var=sink"}, true},
+            {"-jobs=2, then -jobs 4", {"-jobs=2", "-var=sink"}, {"-jobs", "4", "-var=sink"}, true},
+            {"-cache-dir /x, then --cache-dir=/y", {"-cache-dir", "/x"}, {"--cache-dir=/y"}, true},
+            {"-stats -var=sink, then -var=sink", {"-stats", "-var=sink"}, {"-var=sink"}, true},
+            {"-jobs 2 -var=sink, then -jobs 2 -var=j", {"-jobs", "2", "-var=sink"}, {"-jobs", "2", "-var=j"}, false},
+    };
+    unsigned failed = 0;
+    for (const auto &c: cases) {
+        bool found = hit(dir.str().str(), c.first, c.second);
+        llvm::outs() << c.name << ": " << (found ? "hit" : "miss") << (found == c.hit ? "" : " (WRONG)") << "\n";
+        failed += found != c.hit;
+    }
+    llvm::sys::fs::remove_directories(dir);
+    return failed ? 1 : 0;
+}
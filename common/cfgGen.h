@@ -0,0 +1,238 @@
+#ifndef COMMON_CFGGEN_H
+#define COMMON_CFGGEN_H
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+
+/*
+ * Builds synthetic mini C functions directly as LLVM IR, in the same shape clang -O0 gives the
+ * test programs: every variable is an alloca, every use is a load and every assignment a store.
+ * The body is a random sequence of assignments, if/else diamonds and while loops.
+ */
+struct CFGShape {
+    unsigned vars = 16;        // number of local variables besides `source` and `sink`, more than `maxDepth`
+    unsigned statements = 500; // number of top level statements
+    unsigned maxDepth = 2;     // maximum nesting of loops and diamonds
+    unsigned loopBound = 100;  // loops count a variable up to this constant
+    unsigned groups = 1;       // assignments only read variables of the group of their target, and loops only
+                               // assign to the group of their counter; every group needs more than `maxDepth`
+    unsigned seed = 42;
+    // relative weights of the kinds of statements above depth `maxDepth`, not all 0
+    unsigned assignments = 3, diamonds = 2, loops = 1;
+    unsigned sources = 1;      // weight of `source` among the variables read outside of groups (each other one weighs 1)
+    unsigned exprSize = 1;     // number of subtractions in an assignment of an expression
+};
+
+// false if `shape` breaks one of the limits above: the generator would not terminate or would crash on it
+inline bool validShape(const CFGShape &shape) {
+    // the smallest group is the last one, with vars / groups variables
+    return shape.vars > 0 && shape.groups > 0 && shape.vars / shape.groups > shape.maxDepth &&
+           shape.assignments + shape.diamonds + shape.loops > 0;
+}
+
+inline bool setShapeField(CFGShape &shape, llvm::StringRef key, llvm::StringRef value) {
+    unsigned n;
+    if (value.getAsInteger(10, n))
+        return false;
+    unsigned *params[] = {&shape.vars, &shape.statements, &shape.maxDepth, &shape.loopBound, &shape.groups, &shape.seed,
+                          &shape.assignments, &shape.diamonds, &shape.loops, &shape.sources, &shape.exprSize};
+    const char *keys[] = {"vars", "statements", "depth", "bound", "groups", "seed",
+                          "assignments", "diamonds", "loops", "sources", "expr"};
+    for (unsigned i = 0; i < std::size(keys); ++i)
+        if (key == keys[i]) {
+            *params[i] = n;
+            return true;
+        }
+    return false;
+}
+
+// set the parameter `key` (as in `vars=32`: vars, statements, depth, bound, groups, seed, assignments, diamonds,
+// loops, sources, expr) of `shape` from `value`, false (leaving `shape` unchanged) if either is not one or if the
+// resulting shape is not valid
+inline bool setShapeParam(CFGShape &shape, llvm::StringRef key, llvm::StringRef value) {
+    CFGShape result = shape;
+    if (!setShapeField(result, key, value) || !validShape(result))
+        return false;
+    shape = result;
+    return true;
+}
+
+// set the parameters of a comma separated list such as `vars=32,depth=3`, false on the first invalid one or if
+// the resulting shape is not valid
+inline bool parseShape(CFGShape &shape, llvm::StringRef list) {
+    while (!list.empty()) {
+        llvm::StringRef param;
+        std::tie(param, list) = list.split(',');
+        auto keyValue = param.split('=');
+        if (!setShapeField(shape, keyValue.first.trim(), keyValue.second.trim()))
+            return false;
+    }
+    return validShape(shape);
+}
+
+class CFGGenerator {
+public:
+    CFGGenerator(llvm::Module &M, const CFGShape &shape)
+            : M(M), shape(shape), builder(M.getContext()), rng(shape.seed) {}
+
+    llvm::Function *generate(const std::string &name) {
+        auto *i32 = builder.getInt32Ty();
+        F = llvm::Function::Create(llvm::FunctionType::get(i32, false), llvm::Function::ExternalLinkage, name, &M);
+        builder.SetInsertPoint(newBlock("entry"));
+        vars.clear();
+        vars.push_back(builder.CreateAlloca(i32, nullptr, "source"));
+        sink = builder.CreateAlloca(i32, nullptr, "sink");
+        for (unsigned i = 0; i < shape.vars; ++i)
+            vars.push_back(builder.CreateAlloca(i32, nullptr, "v" + std::to_string(i)));
+        for (unsigned i = 1; i < vars.size(); ++i)
+            builder.CreateStore(builder.getInt32(0), vars[i]);
+
+        for (unsigned i = 0; i < shape.statements; ++i)
+            statement(0);
+
+        builder.CreateStore(load(pick()), sink);
+        builder.CreateRet(builder.getInt32(0));
+        return F;
+    }
+
+private:
+    llvm::Module &M;
+    CFGShape shape;
+    llvm::IRBuilder<> builder;
+    std::mt19937 rng;
+    llvm::Function *F = nullptr;
+    std::vector<llvm::AllocaInst *> vars;
+    llvm::AllocaInst *sink = nullptr;
+    std::vector<llvm::AllocaInst *> counters;
+    int group = -1; // the group of the outermost loop counter, -1 outside loops or with a single group
+    unsigned labels = 0;
+
+    llvm::BasicBlock *newBlock(const std::string &name) {
+        return llvm::BasicBlock::Create(M.getContext(), name, F);
+    }
+
+    unsigned random(unsigned n) {
+        return std::uniform_int_distribution<unsigned>(0, n - 1)(rng);
+    }
+
+    // `source` counts `sources` times
+    llvm::AllocaInst *pick() {
+        unsigned i = random(vars.size() + shape.sources - 1);
+        return i < shape.sources ? vars[0] : vars[i - shape.sources + 1];
+    }
+
+    // variable i (from 1) is in group (i - 1) % groups
+    unsigned groupOf(llvm::AllocaInst *var) {
+        return (std::find(vars.begin(), vars.end(), var) - vars.begin() - 1) % shape.groups;
+    }
+
+    llvm::AllocaInst *pickIn(unsigned g) {
+        unsigned size = (vars.size() - 1 - g + shape.groups - 1) / shape.groups;
+        return vars[1 + g + shape.groups * random(size)];
+    }
+
+    // a variable of the group of `target`
+    llvm::AllocaInst *pick(llvm::AllocaInst *target) {
+        return shape.groups <= 1 ? pick() : pickIn(groupOf(target));
+    }
+
+    llvm::AllocaInst *pickTarget() {
+        // never assign to `source` (index 0) or to the counter of an enclosing loop, so every loop terminates
+        llvm::AllocaInst *var;
+        do {
+            var = group < 0 ? vars[1 + random(vars.size() - 1)] : pickIn(group);
+        } while (std::find(counters.begin(), counters.end(), var) != counters.end());
+        return var;
+    }
+
+    llvm::Value *load(llvm::AllocaInst *var) {
+        return builder.CreateLoad(var->getAllocatedType(), var);
+    }
+
+    void assign() {
+        llvm::AllocaInst *target = pickTarget();
+        switch (random(4)) {
+            case 0:
+                builder.CreateStore(builder.getInt32(random(10)), target);
+                break;
+            case 1:
+                builder.CreateStore(load(pick(target)), target);
+                break;
+            case 2:
+                builder.CreateStore(builder.CreateNSWAdd(load(pick(target)), builder.getInt32(1 + random(5)), "add"), target);
+                break;
+            default: {
+                llvm::Value *value = load(pick(target));
+                for (unsigned i = 0; i < std::max(1u, shape.exprSize); ++i)
+                    value = builder.CreateNSWSub(value, load(pick(target)), "sub");
+                builder.CreateStore(value, target);
+                break;
+            }
+        }
+    }
+
+    void statement(unsigned depth) {
+        unsigned kind = depth < shape.maxDepth ? random(shape.assignments + shape.diamonds + shape.loops) : 0;
+        if (depth >= shape.maxDepth || kind < shape.assignments)
+            assign();
+        else if (kind < shape.assignments + shape.diamonds)
+            diamond(depth);
+        else
+            loop(depth);
+    }
+
+    void diamond(unsigned depth) {
+        std::string id = std::to_string(labels++);
+        auto *thenBB = newBlock("if.then" + id), *elseBB = newBlock("if.else" + id), *endBB = newBlock("if.end" + id);
+        auto *cmp = builder.CreateICmpSGT(load(pick()), builder.getInt32(random(10)), "cmp");
+        builder.CreateCondBr(cmp, thenBB, elseBB);
+
+        for (auto *BB: {thenBB, elseBB}) {
+            builder.SetInsertPoint(BB);
+            unsigned n = 1 + random(3);
+            for (unsigned i = 0; i < n; ++i)
+                statement(depth + 1);
+            builder.CreateBr(endBB);
+        }
+        builder.SetInsertPoint(endBB);
+    }
+
+    void loop(unsigned depth) {
+        std::string id = std::to_string(labels++);
+        auto *condBB = newBlock("while.cond" + id), *bodyBB = newBlock("while.body" + id), *endBB = newBlock("while.end" + id);
+        llvm::AllocaInst *counter = pickTarget();
+        builder.CreateStore(builder.getInt32(0), counter);
+        builder.CreateBr(condBB);
+
+        builder.SetInsertPoint(condBB);
+        auto *cmp = builder.CreateICmpSLT(load(counter), builder.getInt32(shape.loopBound), "cmp");
+        builder.CreateCondBr(cmp, bodyBB, endBB);
+
+        builder.SetInsertPoint(bodyBB);
+        counters.push_back(counter);
+        int outer = group;
+        if (shape.groups > 1 && group < 0)
+            group = groupOf(counter);
+        unsigned n = 1 + random(3);
+        for (unsigned i = 0; i < n; ++i)
+            statement(depth + 1);
+        group = outer;
+        counters.pop_back();
+        builder.CreateStore(builder.CreateNSWAdd(load(counter), builder.getInt32(1), "inc"), counter);
+        builder.CreateBr(condBB);
+
+        builder.SetInsertPoint(endBB);
+    }
+};
+
+#endif //COMMON_CFGGEN_H
@@ -0,0 +1,487 @@
+#ifndef COMMON_DRIVER_H
+#define COMMON_DRIVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "fixpoint.h"
+#include "resultCache.h"
+#include "resultWriter.h"
+#include "threadPool.h"
+
+/*
+ * Shared main of the task binaries. The IR file given on the command line is parsed and the analysis of
+ * the task is run on every function with a body, in parallel on a thread pool. Each function is rendered
+ * into its own buffer and the buffers are printed in module order as soon as all the functions before them
+ * are done, so the output does not depend on scheduling.
+ * When more than one function is analysed, the output of each one starts with `=== name ===`.
+ * Bitcode (.bc) input is loaded lazily, every function body is read just before it is analysed and freed after.
+ *
+ * Batch mode: given several files, a directory (every .ll and .bc file below it) or `@list` (one path per line),
+ * all of them are analysed in the same process. Loader threads parse the upcoming files while the current one
+ * is analysed; every parsed module waits in a slot owning its own LLVMContext, which is reused for the next file
+ * once the module is analysed and freed, so at most `--prefetch` + 1 modules are in memory. The output of
+ * each file starts with `==> path <==`.
+ * Throughput figures are printed to stderr at the end.
+ *
+ * With `--cache-dir`, the output of every function is cached on disk under the IR of the function, salted with
+ * a hash of the binary itself and the options of the analysis, so an unchanged function is printed from the cache
+ * without being analysed. Analyses looking beyond the function set `CacheWholeModule`.
+ *
+ * With `--format jsonl` or `--format binary` the analyses write records through a ResultWriter instead of text,
+ * and the headers above become a "function" record before the records of every function (even if it is the only
+ * one) and a "file" record before those of every file.
+ *
+ * `--stats` (LLVM's own option) also prints statistics to stderr: the number of blocks the fixpoint engine visited
+ * and the time the run took on the first line (read by `benchSuite.cpp`), the time spent parsing, in the engine and
+ * on the rest of the work on the functions (mostly turning the states into results and printing them), summed
+ * over threads, then the totals of AllFixpoints. Everything is counted whether or not it is printed.
+ */
+
+// analyse `F` and print the result to `OS`, called concurrently for different functions of the same module
+typedef std::function<void(llvm::Function &F, llvm::raw_ostream &OS)> function_analysis;
+// run the module level part of an analysis, e.g. interprocedural summaries, and return the analysis of its functions
+typedef std::function<function_analysis(llvm::Module &M)> module_analysis;
+
+inline llvm::cl::list<std::string> InputFiles(llvm::cl::Positional, llvm::cl::desc("<IR file | directory | @file list>..."),
+                                              llvm::cl::OneOrMore);
+inline llvm::cl::opt<unsigned> Jobs("jobs", llvm::cl::desc("Number of functions analysed in parallel, 0 for one per core"),
+                                    llvm::cl::init(0));
+inline llvm::cl::opt<unsigned> Loaders("loaders", llvm::cl::desc("Number of threads parsing upcoming files in batch mode"),
+                                       llvm::cl::init(1));
+inline llvm::cl::opt<unsigned> Prefetch("prefetch", llvm::cl::desc("Number of parsed modules waiting for analysis in batch mode"),
+                                        llvm::cl::init(2));
+inline llvm::cl::opt<std::string> CacheDir("cache-dir", llvm::cl::desc("Directory caching the result of every function, "
+                                                                       "can be shared by concurrent runs"));
+inline llvm::cl::opt<unsigned> CacheSize("cache-size", llvm::cl::desc("Size budget of the cache directory in MB"),
+                                         llvm::cl::init(512));
+inline llvm::cl::opt<OutputFormat> Format("format", llvm::cl::desc("Format of the results"),
+                                          llvm::cl::values(clEnumValN(OutputFormat::Text, "text", "for people (default)"),
+                                                           clEnumValN(OutputFormat::JsonLines, "jsonl", "one JSON object per line"),
+                                                           clEnumValN(OutputFormat::Binary, "binary", "length prefixed records")),
+                                          llvm::cl::init(OutputFormat::Text));
+
+// a writer for --format, nullptr for text
+inline std::unique_ptr<ResultWriter> resultWriter(llvm::raw_ostream &OS) {
+    if (Format == OutputFormat::Text)
+        return nullptr;
+    return std::make_unique<ResultWriter>(OS, Format);
+}
+
+// time spent parsing and materializing modules, and analysing them (fixpoints included), for --stats
+inline std::atomic<unsigned long long> ParseNanos{0}, AnalysisNanos{0};
+
+// add the time since `start` to `nanos`
+inline void addTime(std::atomic<unsigned long long> &nanos, std::chrono::steady_clock::time_point start) {
+    nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the result of a function depends on the rest of the module, e.g. through interprocedural summaries
+inline bool CacheWholeModule = false;
+
+// the header of the results of `F`, only printed as text when the module has several functions
+inline void functionHeader(const llvm::Function &F, bool several, llvm::raw_ostream &OS) {
+    if (auto writer = resultWriter(OS))
+        writer->record("function", "name", F.getName());
+    else if (several)
+        OS << "=== " << F.getName() << " ===\n";
+}
+
+inline void fileHeader(const std::string &path, llvm::raw_ostream &OS) {
+    if (auto writer = resultWriter(OS))
+        writer->record("file", "path", path);
+    else
+        OS << "==> " << path << " <==\n";
+}
+
+// Bitcode is loaded lazily: only the module level entities are read, function bodies are materialized when needed.
+// Textual IR is parsed completely.
+inline std::unique_ptr<llvm::Module> loadModule(const std::string &path, llvm::SMDiagnostic &Err, llvm::LLVMContext &Context) {
+    auto start = std::chrono::steady_clock::now();
+    auto module = llvm::getLazyIRFileModule(path, Err, Context);
+    addTime(ParseNanos, start);
+    return module;
+}
+
+// the analysis of the functions of `M`, timing the module level part
+inline function_analysis analyseFunctions(const module_analysis &analyse, llvm::Module &M) {
+    auto start = std::chrono::steady_clock::now();
+    function_analysis functions = analyse(M);
+    addTime(AnalysisNanos, start);
+    return functions;
+}
+
+// analyse every function with a body of `M` on `pool`, returns the number of functions analysed
+inline size_t analyseModule(llvm::Module &M, const function_analysis &analyse, ThreadPool &pool, llvm::raw_ostream &OS,
+                            ResultCache *cache = nullptr) {
+    std::vector<llvm::Function *> functions;
+    for (auto &F: M)
+        if (!F.isDeclaration()) // a body not materialized yet counts as a body
+            functions.push_back(&F);
+
+    std::string moduleKey;
+    if (cache && CacheWholeModule) {
+        llvm::raw_string_ostream module(moduleKey);
+        M.print(module, nullptr);
+        module.flush();
+        moduleKey = ResultCache::hash(moduleKey);
+    }
+
+    // The bitcode reader and the use lists of the globals a body refers to are shared by the whole module,
+    // so bodies are materialized and deleted one at a time. Printing a body for its cache key reads the
+    // module's metadata while materializing another one may add to it, so it is serialised too.
+    // A lazily loaded body is deleted once analysed, memory then grows with the functions being analysed
+    // rather than with the module.
+    std::mutex materializeLock;
+    auto analyseBody = [&](llvm::Function &F, llvm::raw_ostream &out) {
+        bool lazy = F.isMaterializable();
+        std::string key;
+        if (lazy || cache) {
+            std::lock_guard<std::mutex> guard(materializeLock);
+            if (lazy) {
+                auto start = std::chrono::steady_clock::now();
+                llvm::Error E = F.materialize();
+                addTime(ParseNanos, start);
+                if (E) {
+                    llvm::logAllUnhandledErrors(std::move(E), llvm::errs(), "error: failed to materialize " + F.getName() + ": ");
+                    return;
+                }
+            }
+            if (cache) {
+                auto start = std::chrono::steady_clock::now();
+                key = moduleKey;
+                llvm::raw_string_ostream keyOS(key);
+                F.print(keyOS);
+                keyOS.flush();
+                addTime(AnalysisNanos, start);
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (cache) {
+            std::string result;
+            if (!cache->lookup(key, result)) {
+                llvm::raw_string_ostream resultOS(result);
+                analyse(F, resultOS);
+                resultOS.flush();
+                cache->store(key, result);
+            }
+            out << result;
+        } else {
+            analyse(F, out);
+        }
+        addTime(AnalysisNanos, start);
+        if (lazy) {
+            std::lock_guard<std::mutex> guard(materializeLock);
+            F.deleteBody();
+        }
+    };
+
+    if (functions.size() <= 1) {
+        // nothing to run in parallel, print straight away
+        if (!functions.empty()) {
+            functionHeader(*functions.front(), false, OS);
+            analyseBody(*functions.front(), OS);
+        }
+        return functions.size();
+    }
+
+    std::vector<std::string> results(functions.size());
+    std::vector<bool> finished(functions.size(), false);
+    size_t printed = 0;
+    std::mutex lock;
+
+    for (size_t i = 0; i < functions.size(); ++i)
+        pool.submit([&, i] {
+            llvm::raw_string_ostream result(results[i]);
+            analyseBody(*functions[i], result);
+            result.flush();
+
+            // print every finished result that has no unfinished one before it
+            std::lock_guard<std::mutex> guard(lock);
+            finished[i] = true;
+            for (; printed < functions.size() && finished[printed]; ++printed) {
+                functionHeader(*functions[printed], true, OS);
+                OS << results[printed];
+                std::string().swap(results[printed]);
+            }
+        });
+    pool.wait();
+    return functions.size();
+}
+
+// expand the command line inputs into `files`, returns whether they ask for batch mode
+inline bool expandInputs(const std::vector<std::string> &inputs, std::vector<std::string> &files) {
+    bool batch = inputs.size() > 1;
+    for (const auto &input: inputs) {
+        if (input.size() > 1 && input[0] == '@') {
+            // a file list, one path per line
+            batch = true;
+            auto list = llvm::MemoryBuffer::getFile(input.substr(1));
+            if (!list) {
+                llvm::errs() << "error: failed to read file list \"" << input.substr(1) << "\"\n";
+                continue;
+            }
+            for (llvm::line_iterator line(**list); !line.is_at_eof(); ++line)
+                files.push_back(line->trim().str());
+        } else if (llvm::sys::fs::is_directory(input)) {
+            batch = true;
+            std::vector<std::string> found;
+            std::error_code EC;
+            for (llvm::sys::fs::recursive_directory_iterator it(input, EC), end; it != end && !EC; it.increment(EC)) {
+                llvm::StringRef ext = llvm::sys::path::extension(it->path());
+                if (ext == ".ll" || ext == ".bc")
+                    found.push_back(it->path());
+            }
+            if (EC)
+                llvm::errs() << "error: failed to list directory \"" << input << "\": " << EC.message() << "\n";
+            // directory order is up to the file system
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else {
+            files.push_back(input);
+        }
+    }
+    return batch;
+}
+
+// analyse `files` one after the other while loader threads parse the next ones, returns the exit code
+inline int runBatch(const std::vector<std::string> &files, const module_analysis &analyse, ThreadPool &pool,
+                    llvm::raw_ostream &OS, ResultCache *cache = nullptr) {
+    typedef std::chrono::steady_clock clock;
+
+    // A context never frees the types, constants and metadata uniqued in it, so a slot's context is replaced
+    // by a fresh one once it has held RECYCLE_FILES files or RECYCLE_BYTES bytes of IR, keeping memory bounded
+    // by what a few files need rather than growing with the whole input.
+    static constexpr unsigned RECYCLE_FILES = 64;
+    static constexpr uint64_t RECYCLE_BYTES = 64 << 20;
+    struct Slot {
+        std::unique_ptr<llvm::LLVMContext> context = std::make_unique<llvm::LLVMContext>();
+        std::unique_ptr<llvm::Module> module;
+        size_t file = 0;
+        std::string error;
+        // what was parsed into `context` so far
+        unsigned files = 0;
+        uint64_t bytes = 0;
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::deque<Slot *> freeSlots, ready;
+    for (unsigned i = 0; i < Prefetch + 1; ++i) {
+        slots.push_back(std::make_unique<Slot>());
+        freeSlots.push_back(slots.back().get());
+    }
+    size_t nextFile = 0;
+    double parseSeconds = 0;
+    std::mutex lock; // guards the queues and counters above
+    std::condition_variable changed;
+
+    auto start = clock::now();
+    auto load = [&] {
+        while (true) {
+            Slot *slot;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&] { return nextFile == files.size() || !freeSlots.empty(); });
+                if (nextFile == files.size())
+                    return;
+                slot = freeSlots.front();
+                freeSlots.pop_front();
+                slot->file = nextFile++;
+            }
+
+            auto parseStart = clock::now();
+            llvm::SMDiagnostic Err;
+            slot->module = loadModule(files[slot->file], Err, *slot->context);
+            uint64_t size = 0;
+            llvm::sys::fs::file_size(files[slot->file], size);
+            ++slot->files;
+            slot->bytes += size;
+            slot->error.clear();
+            if (!slot->module) {
+                llvm::raw_string_ostream error(slot->error);
+                Err.print(nullptr, error);
+            }
+            std::chrono::duration<double> parsed = clock::now() - parseStart;
+
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                parseSeconds += parsed.count();
+                ready.push_back(slot);
+            }
+            changed.notify_all();
+        }
+    };
+    std::vector<std::thread> loaders;
+    for (unsigned i = 0; i < std::max(1u, std::min<unsigned>(Loaders, Prefetch + 1)); ++i)
+        loaders.emplace_back(load);
+
+    size_t failed = 0, functions = 0;
+    double analyseSeconds = 0;
+    for (size_t done = 0; done < files.size(); ++done) {
+        Slot *slot;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            // files are handed to the loaders in order, so file `done` is loaded or being loaded; the files
+            // loaded after it wait in their slots, and the output does not depend on which loader is faster
+            auto next = ready.end();
+            changed.wait(guard, [&] {
+                next = std::find_if(ready.begin(), ready.end(), [&](Slot *s) { return s->file == done; });
+                return next != ready.end();
+            });
+            slot = *next;
+            ready.erase(next);
+        }
+
+        fileHeader(files[slot->file], OS);
+        if (slot->module) {
+            auto analyseStart = clock::now();
+            functions += analyseModule(*slot->module, analyseFunctions(analyse, *slot->module), pool, OS, cache);
+            analyseSeconds += std::chrono::duration<double>(clock::now() - analyseStart).count();
+            // free the module before the slot is reused
+            slot->module.reset();
+        } else {
+            ++failed;
+            llvm::errs() << "error: failed to load LLVM IR file \"" << files[slot->file] << "\"\n" << slot->error;
+        }
+        if (slot->files >= RECYCLE_FILES || slot->bytes >= RECYCLE_BYTES) {
+            // no module refers to the context any more
+            slot->context = std::make_unique<llvm::LLVMContext>();
+            slot->files = 0;
+            slot->bytes = 0;
+        }
+        OS.flush();
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            freeSlots.push_back(slot);
+        }
+        changed.notify_all();
+    }
+    for (auto &loader: loaders)
+        loader.join();
+
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    llvm::errs() << llvm::format("%zu files (%zu failed), %zu functions in %.3fs: %.1f files/s, %.1f functions/s\n",
+                                 files.size(), failed, functions, seconds, files.size() / seconds, functions / seconds);
+    llvm::errs() << llvm::format("parsing %.3fs over %u loaders, analysis %.3fs on %u threads\n",
+                                 parseSeconds, unsigned(loaders.size()), analyseSeconds, pool.size());
+    if (cache)
+        llvm::errs() << "cache: " << cache->hits() << " hits, " << cache->misses() << " misses\n";
+    return failed ? EXIT_FAILURE : 0;
+}
+
+// the command line the results may depend on: everything but the inputs and the options of the driver
+inline std::string analysisFlags(int argc, char **argv) {
+    static const char *driverOptions[] = {"jobs", "loaders", "prefetch", "cache-dir", "cache-size", "stats"};
+    std::string flags;
+    for (int i = 1; i < argc; ++i) {
+        llvm::StringRef arg(argv[i]);
+        if (std::find(InputFiles.begin(), InputFiles.end(), arg.str()) != InputFiles.end())
+            continue;
+        auto nameValue = arg.ltrim('-').split('=');
+        if (arg.startswith("-") && std::find(std::begin(driverOptions), std::end(driverOptions), nameValue.first) != std::end(driverOptions)) {
+            // `-jobs 4` spells the value as the next argument
+            auto &options = llvm::cl::getRegisteredOptions();
+            auto option = options.find(nameValue.first);
+            if (!arg.contains('=') && option != options.end() &&
+                option->second->getValueExpectedFlag() == llvm::cl::ValueRequired)
+                ++i;
+            continue;
+        }
+        flags.append(arg.str()).push_back('\n');
+    }
+    return flags;
+}
+
+// identifies the code of the analysis, so a rebuilt binary with other behaviour does not read stale results
+inline std::string executableHash(const char *argv0) {
+    std::string path = llvm::sys::fs::getMainExecutable(argv0, reinterpret_cast<void *>(&executableHash));
+    auto binary = llvm::MemoryBuffer::getFile(path);
+    return binary ? ResultCache::hash((*binary)->getBuffer()) : path;
+}
+
+// the salt of the cache entries of a run: the binary and the options of the analysis
+inline std::string cacheSalt(int argc, char **argv) {
+    return executableHash(argv[0]) + "\n" + analysisFlags(argc, argv) + "\n";
+}
+
+inline void printStats(std::chrono::steady_clock::time_point start) {
+    if (!llvm::AreStatisticsEnabled())
+        return;
+    FixpointStats fixpoints = AllFixpoints.stats();
+    double analysis = AnalysisNanos * 1e-9;
+    llvm::errs() << llvm::format("stats: %llu block visits in %.3fs\n", fixpoints.visits,
+                                 std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    llvm::errs() << llvm::format("  parse %.3fs, fixpoint %.3fs, print %.3fs\n", ParseNanos * 1e-9,
+                                 fixpoints.seconds, std::max(0.0, analysis - fixpoints.seconds));
+    AllFixpoints.print(llvm::errs());
+}
+
+inline int runDriver(int argc, char **argv, const char *overview, const module_analysis &analyse) {
+    auto start = std::chrono::steady_clock::now();
+    llvm::cl::ParseCommandLineOptions(argc, argv, overview);
+    if (Format == OutputFormat::Binary)
+        llvm::sys::ChangeStdoutToBinary();
+
+    ThreadPool pool(Jobs ? Jobs : std::thread::hardware_concurrency());
+    std::unique_ptr<ResultCache> cache;
+    if (!CacheDir.empty())
+        cache = std::make_unique<ResultCache>(CacheDir, uint64_t(CacheSize) << 20, cacheSalt(argc, argv));
+
+    std::vector<std::string> files;
+    if (expandInputs(InputFiles, files)) {
+        int status = runBatch(files, analyse, pool, llvm::outs(), cache.get());
+        if (cache)
+            cache->trim();
+        printStats(start);
+        return status;
+    }
+
+    // Modules are the top level container of all other LLVM Intermediate Representation (IR) objects.
+    // Read the IR file.
+    llvm::SMDiagnostic Err;
+    llvm::LLVMContext Context;  //A reference to the core LLVM "engine" that you should pass to the various methods that require a LLVMContext.
+    std::unique_ptr<llvm::Module> Mod(loadModule(files.front(), Err, Context));
+    if (!Mod) {
+        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", files.front().c_str());
+        return EXIT_FAILURE;
+    }
+
+    analyseModule(*Mod, analyseFunctions(analyse, *Mod), pool, llvm::outs(), cache.get());
+    if (cache)
+        cache->trim();
+    printStats(start);
+    return 0;
+}
+
+inline int runDriver(int argc, char **argv, const char *overview, const function_analysis &analyse) {
+    return runDriver(argc, argv, overview, [&analyse](llvm::Module &) { return analyse; });
+}
+
+#endif //COMMON_DRIVER_H
@@ -0,0 +1,393 @@
+#ifndef COMMON_FIXPOINT_H
+#define COMMON_FIXPOINT_H
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+enum class Direction { Forward, Backward };
+
+// the name of a block, or its number if it has none (utils.cpp of each task)
+std::string getSimpleNodeLabel(const llvm::BasicBlock *Node);
+
+struct FixpointStats {
+    unsigned long long visits = 0; // number of times a transfer function was applied
+    unsigned long long pushes = 0; // number of times a block was added to the worklist
+    unsigned long long widenings = 0; // number of times a state was widened at a loop head
+    unsigned long long joins = 0; // number of times a state was joined into another
+    unsigned long long narrowings = 0; // number of times the state of a loop head was narrowed
+    unsigned long long narrowingPasses = 0; // number of passes descend() made over the blocks
+    unsigned long long copies = 0; // number of states copied
+    unsigned long long largestState = 0; // the largest stateSize() of a state a transfer function produced
+    double seconds = 0; // time spent in run() and descend()
+
+    FixpointStats &operator+=(const FixpointStats &other);
+};
+
+// the size of a state in the statistics: its size() by default (members of a set, entries of a map, bits or
+// variables), a domain measuring it otherwise overloads stateSize for its state
+template <typename State>
+auto stateSize(const State &state) -> decltype(static_cast<unsigned long long>(state.size())) {
+    return state.size();
+}
+
+/*
+ * The statistics of every fixpoint computed in the process, for --stats. Every Fixpoint counts into its own
+ * FixpointStats and a visit counter per block, which cost a few increments per visit, and adds them here once
+ * it is destroyed, with the names of the blocks visited the most.
+ */
+class FixpointTotals {
+public:
+    void add(const FixpointStats &stats, const std::vector<llvm::BasicBlock *> &blocks,
+             const std::vector<unsigned> &visits, const std::vector<char> &heads);
+    [[nodiscard]] FixpointStats stats() const;
+    // a few lines of totals, averages and the hottest blocks
+    void print(llvm::raw_ostream &OS) const;
+
+private:
+    static constexpr unsigned HOTTEST = 5;
+
+    mutable std::mutex lock;
+    FixpointStats totals;
+    unsigned long long fixpoints = 0, blocks = 0, loopHeads = 0, headVisits = 0;
+    // the blocks visited the most by a single fixpoint, as function:block and whether a loop head, the most first
+    std::vector<std::pair<unsigned, std::pair<std::string, bool>>> hottest;
+};
+
+inline FixpointTotals AllFixpoints;
+
+/*
+ * Worklist fixpoint solver keeping a single state per block.
+ *
+ * Blocks are numbered in reverse post-order for forward analyses and in post-order for
+ * backward analyses. The worklist always hands out the pending block with the smallest
+ * number, and a block is only put back on the worklist when the state flowing into it changes.
+ *
+ * in(BB) is the state the transfer function starts from (the entry of the block for a forward
+ * analysis, the exit for a backward one) and out(BB) is the state it produced.
+ *
+ * Domains of infinite height pass a widening to run(). A block reached along a retreating edge (from
+ * itself or a block later in the order, so every cycle has one) is a loop head, and once `delay` states
+ * have been joined into it along retreating edges, the following ones are widened in instead.
+ * descend() then recovers precision: passes over the blocks in order recompute every state from its
+ * neighbours, except that the states of loop heads are narrowed with theirs.
+ */
+template <typename State>
+class Fixpoint {
+public:
+    // pass `state` to the neighbour `BB` (successor if forward, predecessor if backward)
+    typedef std::function<void(llvm::BasicBlock *BB, const State &state)> emit_fn;
+    // turn the input state of `BB` into its output state in place, and emit the state along each edge
+    typedef std::function<void(llvm::BasicBlock *BB, State &state, const emit_fn &emit)> transfer_fn;
+    // merge `incoming` into `into`, return whether `into` changed
+    typedef std::function<bool(State &into, const State &incoming)> join_fn;
+
+    Fixpoint(llvm::Function &F, Direction dir);
+    Fixpoint(const Fixpoint &) = delete;
+    Fixpoint &operator=(const Fixpoint &) = delete;
+    // adds the statistics to AllFixpoints
+    ~Fixpoint();
+
+    // `init` is the input state of the entry block (forward) or of every exit block (backward).
+    // `widen` merges states into loop heads like `join`, but so that they can only grow finitely often
+    void run(const State &init, const transfer_fn &transfer, const join_fn &join,
+             const join_fn &widen = nullptr, unsigned delay = 0);
+    // descending passes after run(), until no state changes or `maxPasses` passes are done. `narrow` refines
+    // the state of a loop head with the join of the states now flowing into it. Needs State::operator==
+    void descend(const State &init, const transfer_fn &transfer, const join_fn &join, const join_fn &narrow,
+                 unsigned maxPasses);
+
+    [[nodiscard]] bool reached(const llvm::BasicBlock *BB) const;
+    [[nodiscard]] const State &in(const llvm::BasicBlock *BB) const;
+    [[nodiscard]] const State &out(const llvm::BasicBlock *BB) const;
+    // reachable blocks in processing order
+    [[nodiscard]] const std::vector<llvm::BasicBlock *> &blocks() const { return order; }
+    [[nodiscard]] const FixpointStats &stats() const { return fixStats; }
+
+private:
+    Direction dir;
+    std::vector<llvm::BasicBlock *> order;
+    std::unordered_map<const llvm::BasicBlock *, unsigned> index;
+    std::vector<State> inStates, outStates;
+    std::vector<char> seen, queued, heads;
+    std::vector<unsigned> visitCounts;
+    FixpointStats fixStats;
+    const State empty{};
+
+    [[nodiscard]] bool isStart(unsigned i) const;
+};
+
+
+template <typename State>
+Fixpoint<State>::Fixpoint(llvm::Function &F, Direction dir): dir(dir) {
+    llvm::ReversePostOrderTraversal<llvm::Function *> RPOT(&F);
+    order.assign(RPOT.begin(), RPOT.end());
+    if (dir == Direction::Backward)
+        std::reverse(order.begin(), order.end());
+    for (unsigned i = 0; i < order.size(); ++i)
+        index[order[i]] = i;
+    inStates.resize(order.size());
+    outStates.resize(order.size());
+    seen.assign(order.size(), 0);
+    queued.assign(order.size(), 0);
+    heads.assign(order.size(), 0);
+    visitCounts.assign(order.size(), 0);
+}
+
+template <typename State>
+Fixpoint<State>::~Fixpoint() {
+    AllFixpoints.add(fixStats, order, visitCounts, heads);
+}
+
+template <typename State>
+bool Fixpoint<State>::isStart(unsigned i) const {
+    return dir == Direction::Forward ? order[i] == &order[i]->getParent()->getEntryBlock()
+                                     : llvm::succ_empty(order[i]);
+}
+
+template <typename State>
+void Fixpoint<State>::run(const State &init, const transfer_fn &transfer, const join_fn &join,
+                          const join_fn &widen, unsigned delay) {
+    auto start = std::chrono::steady_clock::now();
+    std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>> worklist;
+    auto push = [&](unsigned i) {
+        if (queued[i])
+            return;
+        queued[i] = 1;
+        worklist.push(i);
+        ++fixStats.pushes;
+    };
+
+    // the block being processed, and the number of states joined into each loop head along retreating edges
+    unsigned current = 0;
+    std::vector<unsigned> retreatingJoins(order.size(), 0);
+    emit_fn emit = [&](llvm::BasicBlock *BB, const State &state) {
+        auto it = index.find(BB);
+        if (it == index.end())
+            // unreachable from the entry block
+            return;
+        unsigned i = it->second;
+        if (!seen[i]) {
+            // the first state to arrive is taken as is, which gives `must` analyses their top element
+            seen[i] = 1;
+            inStates[i] = state;
+            ++fixStats.copies;
+            push(i);
+            return;
+        }
+        bool widening = false;
+        if (i <= current) {
+            heads[i] = 1;
+            widening = widen && ++retreatingJoins[i] > delay;
+        }
+        if (widening) {
+            ++fixStats.widenings;
+            if (widen(inStates[i], state))
+                push(i);
+        } else {
+            ++fixStats.joins;
+            if (join(inStates[i], state))
+                push(i);
+        }
+    };
+
+    // seed the worklist
+    for (unsigned i = 0; i < order.size(); ++i) {
+        if (isStart(i)) {
+            seen[i] = 1;
+            inStates[i] = init;
+            push(i);
+        }
+    }
+
+    while (!worklist.empty()) {
+        unsigned i = worklist.top();
+        worklist.pop();
+        queued[i] = 0;
+        ++fixStats.visits;
+        ++visitCounts[i];
+
+        current = i;
+        State state = inStates[i];
+        ++fixStats.copies;
+        transfer(order[i], state, emit);
+        fixStats.largestState = std::max<unsigned long long>(fixStats.largestState, stateSize(state));
+        outStates[i] = std::move(state);
+    }
+    fixStats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename State>
+void Fixpoint<State>::descend(const State &init, const transfer_fn &transfer, const join_fn &join,
+                              const join_fn &narrow, unsigned maxPasses) {
+    if (std::find(heads.begin(), heads.end(), 1) == heads.end())
+        return; // no loops, already exact
+    auto start = std::chrono::steady_clock::now();
+
+    // states along forward edges arrive in the same pass, along retreating edges in the next one
+    std::vector<State> forward(order.size()), retreating(order.size()), nextRetreating(order.size());
+    std::vector<char> hasForward(order.size(), 0), hasRetreating(order.size(), 0), hasNextRetreating(order.size(), 0);
+    unsigned current = 0;
+    auto merge = [&](State &into, char &has, const State &state) {
+        if (has) {
+            ++fixStats.joins;
+            join(into, state);
+        } else {
+            into = state;
+            ++fixStats.copies;
+        }
+        has = 1;
+    };
+    emit_fn emit = [&](llvm::BasicBlock *BB, const State &state) {
+        auto it = index.find(BB);
+        if (it == index.end())
+            return;
+        unsigned i = it->second;
+        if (i <= current)
+            merge(nextRetreating[i], hasNextRetreating[i], state);
+        else
+            merge(forward[i], hasForward[i], state);
+    };
+
+    // the first pass only replays the fixpoint to collect the states along retreating edges
+    for (unsigned pass = 0; pass <= maxPasses; ++pass) {
+        bool changed = false;
+        for (current = 0; current < order.size(); ++current) {
+            unsigned i = current;
+            if (!seen[i])
+                continue;
+            if (pass > 0) {
+                State incoming;
+                char has = 0;
+                if (isStart(i))
+                    merge(incoming, has, init);
+                if (hasForward[i])
+                    merge(incoming, has, forward[i]);
+                if (hasRetreating[i])
+                    merge(incoming, has, retreating[i]);
+                // a block nothing flows into any more keeps its state
+                if (has && heads[i]) {
+                    ++fixStats.narrowings;
+                    changed |= narrow(inStates[i], incoming);
+                } else if (has && !(incoming == inStates[i])) {
+                    inStates[i] = std::move(incoming);
+                    changed = true;
+                }
+            }
+            hasForward[i] = 0;
+            ++fixStats.visits;
+            ++visitCounts[i];
+
+            State state = inStates[i];
+            ++fixStats.copies;
+            transfer(order[i], state, emit);
+            fixStats.largestState = std::max<unsigned long long>(fixStats.largestState, stateSize(state));
+            outStates[i] = std::move(state);
+        }
+        retreating.swap(nextRetreating);
+        hasRetreating.swap(hasNextRetreating);
+        std::fill(hasNextRetreating.begin(), hasNextRetreating.end(), 0);
+        if (pass > 0) {
+            ++fixStats.narrowingPasses;
+            // the same states flow along the retreating edges again
+            if (!changed)
+                break;
+        }
+    }
+    fixStats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename State>
+bool Fixpoint<State>::reached(const llvm::BasicBlock *BB) const {
+    auto it = index.find(BB);
+    return it != index.end() && seen[it->second];
+}
+
+template <typename State>
+const State &Fixpoint<State>::in(const llvm::BasicBlock *BB) const {
+    auto it = index.find(BB);
+    return it == index.end() ? empty : inStates[it->second];
+}
+
+template <typename State>
+const State &Fixpoint<State>::out(const llvm::BasicBlock *BB) const {
+    auto it = index.find(BB);
+    return it == index.end() ? empty : outStates[it->second];
+}
+
+inline FixpointStats &FixpointStats::operator+=(const FixpointStats &other) {
+    visits += other.visits;
+    pushes += other.pushes;
+    widenings += other.widenings;
+    joins += other.joins;
+    narrowings += other.narrowings;
+    narrowingPasses += other.narrowingPasses;
+    copies += other.copies;
+    largestState = std::max(largestState, other.largestState);
+    seconds += other.seconds;
+    return *this;
+}
+
+inline void FixpointTotals::add(const FixpointStats &stats, const std::vector<llvm::BasicBlock *> &blocks,
+                                const std::vector<unsigned> &visits, const std::vector<char> &heads) {
+    std::lock_guard<std::mutex> guard(lock);
+    totals += stats;
+    ++fixpoints;
+    this->blocks += blocks.size();
+    for (unsigned i = 0; i < blocks.size(); ++i) {
+        if (heads[i]) {
+            ++loopHeads;
+            headVisits += visits[i];
+        }
+        // only the blocks making it into the list are named
+        if (hottest.size() == HOTTEST && visits[i] <= hottest.back().first)
+            continue;
+        std::string name = blocks[i]->getParent()->getName().str() + ":" + getSimpleNodeLabel(blocks[i]);
+        auto at = std::upper_bound(hottest.begin(), hottest.end(), visits[i],
+                                   [](unsigned count, const auto &hot) { return count > hot.first; });
+        hottest.insert(at, {visits[i], {name, heads[i] != 0}});
+        if (hottest.size() > HOTTEST)
+            hottest.pop_back();
+    }
+}
+
+inline FixpointStats FixpointTotals::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return totals;
+}
+
+inline void FixpointTotals::print(llvm::raw_ostream &OS) const {
+    std::lock_guard<std::mutex> guard(lock);
+    auto perVisit = [&](unsigned long long count) { return totals.visits ? double(count) / totals.visits : 0.0; };
+    OS << llvm::format("  %llu fixpoints over %llu blocks, %.1f visits per block\n", fixpoints, blocks,
+                       blocks ? double(totals.visits) / blocks : 0.0);
+    OS << llvm::format("  %llu worklist pushes, %llu state copies (%.2f per visit)\n", totals.pushes, totals.copies,
+                       perVisit(totals.copies));
+    OS << llvm::format("  %llu joins (%.2f per visit), %llu widenings, %llu narrowings in %llu descending passes\n",
+                       totals.joins, perVisit(totals.joins), totals.widenings, totals.narrowings, totals.narrowingPasses);
+    OS << llvm::format("  %llu loop heads, %.1f iterations per head\n", loopHeads,
+                       loopHeads ? double(headVisits) / loopHeads : 0.0);
+    OS << llvm::format("  largest state %llu, %.3fs in the engine, %.2fus per visit\n", totals.largestState,
+                       totals.seconds, totals.visits ? totals.seconds * 1e6 / totals.visits : 0.0);
+    if (hottest.empty())
+        return;
+    OS << "  hottest blocks:";
+    for (size_t i = 0; i < hottest.size(); ++i)
+        OS << (i ? ", " : " ") << hottest[i].second.first << " " << hottest[i].first
+           << (hottest[i].second.second ? " (loop head)" : "");
+    OS << "\n";
+}
+
+#endif //COMMON_FIXPOINT_H
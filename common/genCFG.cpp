@@ -0,0 +1,59 @@
+#include <string>
+#include <system_error>
+
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "cfgGen.h"
+
+/*
+ * Writes a module of synthetic functions (see cfgGen.h), to try the analyses on inputs of any size:
+ *     ./genCFG --shape=vars=64,statements=2000,depth=3 -o big.ll
+ *     ../a1_taint_and_VB_analysis/task4 big.ll
+ * Textual IR, or bitcode when the output ends in .bc.
+ */
+
+static llvm::cl::opt<std::string> Output("o", llvm::cl::desc("Output file, .ll or .bc"), llvm::cl::value_desc("file"),
+                                         llvm::cl::Required);
+static llvm::cl::opt<std::string> Shape("shape", llvm::cl::desc("Parameters of the functions, e.g. vars=32,depth=3 "
+                                                                "(vars, statements, depth, bound, groups, seed, "
+                                                                "assignments, diamonds, loops, sources, expr)"));
+static llvm::cl::opt<unsigned> Functions("functions", llvm::cl::desc("Number of functions, each with the next seed"),
+                                         llvm::cl::init(1));
+
+int main(int argc, char **argv) {
+    llvm::cl::ParseCommandLineOptions(argc, argv, "synthetic CFG generator\n");
+    CFGShape shape;
+    if (!parseShape(shape, Shape)) {
+        llvm::errs() << "error: invalid shape \"" << Shape << "\"\n";
+        return 1;
+    }
+
+    llvm::LLVMContext Context;
+    llvm::Module M("generated", Context);
+    for (unsigned i = 0; i < Functions; ++i) {
+        CFGShape functionShape = shape;
+        functionShape.seed += i;
+        CFGGenerator(M, functionShape).generate(Functions == 1 ? "main" : "f" + std::to_string(i));
+    }
+    if (llvm::verifyModule(M, &llvm::errs()))
+        return 1;
+
+    std::error_code EC;
+    bool bitcode = llvm::StringRef(Output).endswith(".bc");
+    llvm::raw_fd_ostream OS(Output, EC, bitcode ? llvm::sys::fs::F_None : llvm::sys::fs::F_Text);
+    if (EC) {
+        llvm::errs() << "error: cannot write \"" << Output << "\": " << EC.message() << "\n";
+        return 1;
+    }
+    if (bitcode)
+        llvm::WriteBitcodeToFile(M, OS);
+    else
+        M.print(OS, nullptr);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef COMMON_HASHCONS_H
+#define COMMON_HASHCONS_H
+
+#include <cstddef>
+#include <unordered_set>
+#include <utility>
+
+#include "llvm/ADT/Hashing.h"
+
+// the hash of a state for HashCons: the sum of the llvm::hash_value of its elements by default, so that it does
+// not depend on the order the container lists them in (a PersistentMap may list the same entries in another
+// order). A domain hashing its state otherwise overloads hashState for it
+template <typename State>
+size_t hashState(const State &state) {
+    size_t hash = state.size();
+    for (const auto &element: state)
+        hash += llvm::hash_value(element);
+    return hash;
+}
+
+/*
+ * Hash-consing of abstract states: intern() keeps a single copy of every distinct state and hands it out, so two
+ * interned states are equal exactly when they are the same pointer, and a state pushed many times is kept once.
+ * The DFS drivers push interned states, which turns checking whether a (block, state) pair was pushed before into
+ * a lookup of two pointers. The states live as long as the table.
+ */
+template <typename State>
+class HashCons {
+public:
+    // the copy of `state` in the table, made if there is none
+    const State *intern(const State &state) {
+        ++lookups;
+        return &*states.insert(state).first;
+    }
+    const State *intern(State &&state) {
+        ++lookups;
+        return &*states.insert(std::move(state)).first;
+    }
+
+    // number of distinct states
+    [[nodiscard]] size_t size() const { return states.size(); }
+    // number of states interned that were there already
+    [[nodiscard]] unsigned long long hits() const { return lookups - states.size(); }
+
+private:
+    struct Hash {
+        size_t operator()(const State &state) const { return hashState(state); }
+    };
+
+    // the nodes of an unordered_set do not move, so the pointers stay valid
+    std::unordered_set<State, Hash> states;
+    unsigned long long lookups = 0;
+};
+
+#endif //COMMON_HASHCONS_H
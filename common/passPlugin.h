@@ -0,0 +1,58 @@
+#ifndef COMMON_PASSPLUGIN_H
+#define COMMON_PASSPLUGIN_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+
+/*
+ * Shared by the pass plugins of both assignments (analysisPasses.cpp), which package the analyses as analysis
+ * passes of the legacy pass manager, the one `opt` and clang run in LLVM 7.
+ *
+ * `opt -analyze` prints an analysis pass itself. Clang has no such mode, so a plugin also registers an
+ * AnalysisPrinter per analysis with RegisterPrinter, added to clang's pipeline when its option is given.
+ */
+
+// prints the results of the analysis pass `Analysis` for every function to stdout, with its print()
+template <typename Analysis>
+class AnalysisPrinter : public llvm::FunctionPass {
+public:
+    static char ID;
+    AnalysisPrinter(): FunctionPass(ID) {}
+
+    bool runOnFunction(llvm::Function &F) override {
+        llvm::outs() << "=== " << F.getName() << " ===\n";
+        getAnalysis<Analysis>().print(llvm::outs(), F.getParent());
+        return false;
+    }
+
+    void getAnalysisUsage(llvm::AnalysisUsage &AU) const override {
+        AU.addRequired<Analysis>();
+        AU.setPreservesAll();
+    }
+};
+
+template <typename Analysis>
+char AnalysisPrinter<Analysis>::ID = 0;
+
+// Adds an AnalysisPrinter<Analysis> at the start of the function pipeline, which runs at every optimisation
+// level and still sees the allocas the analyses work on, when `enabled` is set (e.g. `clang -mllvm -report-taint`).
+// `enabled` must outlive the registration, both are static objects of the plugin.
+template <typename Analysis>
+class RegisterPrinter {
+public:
+    explicit RegisterPrinter(const llvm::cl::opt<bool> &enabled)
+            : registration(llvm::PassManagerBuilder::EP_EarlyAsPossible,
+                           [&enabled](const llvm::PassManagerBuilder &, llvm::legacy::PassManagerBase &PM) {
+                               if (enabled)
+                                   PM.add(new AnalysisPrinter<Analysis>());
+                           }) {}
+
+private:
+    llvm::RegisterStandardPasses registration;
+};
+
+#endif //COMMON_PASSPLUGIN_H
@@ -0,0 +1,292 @@
+#ifndef COMMON_PERSISTENTMAP_H
+#define COMMON_PERSISTENTMAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+ * Hash map with structural sharing (a hash array mapped trie): copying a map copies a pointer, and the copies
+ * share every node until one of them writes to it. A write copies the nodes on the path to the key that are still
+ * shared, so it costs O(log n) whatever the size of the map, and the copies of an abstract state made at every
+ * branch only keep the nodes they changed.
+ *
+ * Each node has 32 slots, indexed by 5 bits of the (mixed) hash of the key. A slot holds an entry if it is the
+ * only key with that hash prefix and a child node otherwise; erase() keeps it that way, so two maps with the
+ * same entries have the same shape, and comparing them skips the nodes they share. Keys with the same 64 bit
+ * hash end up in a list past the last level.
+ *
+ * The interface is the part of std::unordered_map the analyses use. Iteration is read only, and a reference
+ * returned by operator[] is only good until the map is copied.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class PersistentMap {
+public:
+    typedef std::pair<K, V> value_type;
+    class const_iterator;
+
+    [[nodiscard]] size_t size() const { return entryCount; }
+    [[nodiscard]] bool empty() const { return entryCount == 0; }
+
+    // the value of `key`, default constructed if it was not there
+    V &operator[](const K &key);
+    // nullptr if `key` is not there
+    [[nodiscard]] const V *lookup(const K &key) const;
+    [[nodiscard]] size_t count(const K &key) const { return lookup(key) ? 1 : 0; }
+    size_t erase(const K &key);
+
+    // calls `fn` with the entries of `other`, skipping the nodes it shares with this map
+    template <typename Fn>
+    void forEachUnshared(const PersistentMap &other, Fn fn) const { unshared(root.get(), other.root.get(), fn); }
+
+    [[nodiscard]] const_iterator begin() const { return const_iterator(root.get()); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(); }
+    [[nodiscard]] const_iterator cbegin() const { return begin(); }
+    [[nodiscard]] const_iterator cend() const { return end(); }
+
+    bool operator==(const PersistentMap &other) const {
+        return entryCount == other.entryCount && (entryCount == 0 || equal(root.get(), other.root.get(), 0));
+    }
+    bool operator!=(const PersistentMap &other) const { return !(*this == other); }
+
+private:
+    static const unsigned BITS = 5;
+
+    struct Node {
+        uint32_t entryMap = 0, nodeMap = 0;
+        // in the order of the slots set in entryMap and nodeMap
+        std::vector<value_type> entries;
+        std::vector<std::shared_ptr<Node>> nodes;
+    };
+
+    std::shared_ptr<Node> root;
+    size_t entryCount = 0;
+
+    static uint64_t hashOf(const K &key) {
+        // pointers hash to themselves, with their low bits always zero
+        uint64_t hash = Hash()(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+    static uint32_t bitOf(uint64_t hash, unsigned shift) { return 1u << ((hash >> shift) & 31); }
+    static unsigned index(uint32_t map, uint32_t bit) { return __builtin_popcount(map & (bit - 1)); }
+    // a node only this map refers to, copied if it was shared
+    static Node *own(std::shared_ptr<Node> &node) {
+        if (!node)
+            node = std::make_shared<Node>();
+        else if (node.use_count() > 1)
+            node = std::make_shared<Node>(*node);
+        return node.get();
+    }
+    static bool equal(const Node *one, const Node *oth, unsigned shift);
+    template <typename Fn>
+    static void unshared(const Node *mine, const Node *theirs, Fn &fn) {
+        if (!theirs || mine == theirs)
+            return;
+        for (auto &entry: theirs->entries)
+            fn(entry);
+        unsigned i = 0;
+        for (uint32_t slots = theirs->nodeMap; slots; slots &= slots - 1, ++i) {
+            uint32_t bit = slots & -slots;
+            bool both = mine && (mine->nodeMap & bit);
+            unshared(both ? mine->nodes[index(mine->nodeMap, bit)].get() : nullptr, theirs->nodes[i].get(), fn);
+        }
+    }
+
+public:
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename PersistentMap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type *pointer;
+        typedef const value_type &reference;
+
+        const_iterator() = default;
+        explicit const_iterator(const Node *root) {
+            if (root) {
+                stack.emplace_back(root, 0);
+                advance();
+            }
+        }
+
+        reference operator*() const { return *current; }
+        pointer operator->() const { return current; }
+        const_iterator &operator++() {
+            advance();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            advance();
+            return old;
+        }
+        bool operator==(const const_iterator &other) const { return current == other.current; }
+        bool operator!=(const const_iterator &other) const { return current != other.current; }
+
+    private:
+        // the nodes being visited and the next slot of each, entries first
+        std::vector<std::pair<const Node *, unsigned>> stack;
+        const value_type *current = nullptr;
+
+        void advance() {
+            while (!stack.empty()) {
+                const Node *node = stack.back().first;
+                unsigned pos = stack.back().second++;
+                if (pos < node->entries.size()) {
+                    current = &node->entries[pos];
+                    return;
+                }
+                pos -= node->entries.size();
+                if (pos < node->nodes.size())
+                    stack.emplace_back(node->nodes[pos].get(), 0);
+                else
+                    stack.pop_back();
+            }
+            current = nullptr;
+        }
+    };
+};
+
+template <typename K, typename V, typename Hash>
+V &PersistentMap<K, V, Hash>::operator[](const K &key) {
+    uint64_t hash = hashOf(key);
+    Node *node = own(root);
+    for (unsigned shift = 0;; shift += BITS) {
+        if (shift >= 64) {
+            // the same hash
+            for (auto &entry: node->entries)
+                if (entry.first == key)
+                    return entry.second;
+            ++entryCount;
+            node->entries.emplace_back(key, V());
+            return node->entries.back().second;
+        }
+        uint32_t bit = bitOf(hash, shift);
+        if (node->nodeMap & bit) {
+            node = own(node->nodes[index(node->nodeMap, bit)]);
+            continue;
+        }
+        unsigned i = index(node->entryMap, bit);
+        if (!(node->entryMap & bit)) {
+            ++entryCount;
+            node->entryMap |= bit;
+            return node->entries.insert(node->entries.begin() + i, value_type(key, V()))->second;
+        }
+        if (node->entries[i].first == key)
+            return node->entries[i].second;
+
+        // another key with the same prefix: both go one level down
+        auto child = std::make_shared<Node>();
+        if (shift + BITS < 64)
+            child->entryMap = bitOf(hashOf(node->entries[i].first), shift + BITS);
+        child->entries.push_back(std::move(node->entries[i]));
+        node->entries.erase(node->entries.begin() + i);
+        node->entryMap ^= bit;
+        node->nodeMap |= bit;
+        node = node->nodes.insert(node->nodes.begin() + index(node->nodeMap, bit), std::move(child))->get();
+    }
+}
+
+template <typename K, typename V, typename Hash>
+const V *PersistentMap<K, V, Hash>::lookup(const K &key) const {
+    uint64_t hash = hashOf(key);
+    const Node *node = root.get();
+    for (unsigned shift = 0; node; shift += BITS) {
+        if (shift >= 64) {
+            for (auto &entry: node->entries)
+                if (entry.first == key)
+                    return &entry.second;
+            return nullptr;
+        }
+        uint32_t bit = bitOf(hash, shift);
+        if (node->nodeMap & bit) {
+            node = node->nodes[index(node->nodeMap, bit)].get();
+        } else if (node->entryMap & bit) {
+            const value_type &entry = node->entries[index(node->entryMap, bit)];
+            return entry.first == key ? &entry.second : nullptr;
+        } else {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+template <typename K, typename V, typename Hash>
+size_t PersistentMap<K, V, Hash>::erase(const K &key) {
+    // nothing is copied for a missing key
+    if (!lookup(key))
+        return 0;
+    uint64_t hash = hashOf(key);
+    // the nodes above `node` and the slot leading down from each
+    std::vector<std::pair<Node *, uint32_t>> path;
+    Node *node = own(root);
+    for (unsigned shift = 0;; shift += BITS) {
+        if (shift >= 64) {
+            for (auto it = node->entries.begin(); it != node->entries.end(); ++it)
+                if (it->first == key) {
+                    node->entries.erase(it);
+                    break;
+                }
+            break;
+        }
+        uint32_t bit = bitOf(hash, shift);
+        if (node->nodeMap & bit) {
+            path.emplace_back(node, bit);
+            node = own(node->nodes[index(node->nodeMap, bit)]);
+            continue;
+        }
+        node->entries.erase(node->entries.begin() + index(node->entryMap, bit));
+        node->entryMap ^= bit;
+        break;
+    }
+    --entryCount;
+
+    // a node left with a single entry hands it to its parent, and an empty one goes away
+    while (!path.empty() && node->nodes.empty() && node->entries.size() <= 1) {
+        auto [parent, bit] = path.back();
+        path.pop_back();
+        bool single = node->entries.size() == 1;
+        value_type entry = single ? std::move(node->entries.front()) : value_type();
+        parent->nodes.erase(parent->nodes.begin() + index(parent->nodeMap, bit));
+        parent->nodeMap ^= bit;
+        if (single) {
+            parent->entryMap |= bit;
+            parent->entries.insert(parent->entries.begin() + index(parent->entryMap, bit), std::move(entry));
+        }
+        node = parent;
+    }
+    if (entryCount == 0)
+        root.reset();
+    return 1;
+}
+
+template <typename K, typename V, typename Hash>
+bool PersistentMap<K, V, Hash>::equal(const Node *one, const Node *oth, unsigned shift) {
+    if (one == oth)
+        return true;
+    if (one->entryMap != oth->entryMap || one->nodeMap != oth->nodeMap || one->entries.size() != oth->entries.size())
+        return false;
+    if (shift >= 64) {
+        // in insertion order
+        for (auto &entry: one->entries)
+            if (std::find(oth->entries.begin(), oth->entries.end(), entry) == oth->entries.end())
+                return false;
+        return true;
+    }
+    for (unsigned i = 0; i < one->entries.size(); ++i)
+        if (one->entries[i] != oth->entries[i])
+            return false;
+    for (unsigned i = 0; i < one->nodes.size(); ++i)
+        if (!equal(one->nodes[i].get(), oth->nodes[i].get(), shift + BITS))
+            return false;
+    return true;
+}
+
+#endif //COMMON_PERSISTENTMAP_H
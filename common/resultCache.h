@@ -0,0 +1,124 @@
+#ifndef COMMON_RESULTCACHE_H
+#define COMMON_RESULTCACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <sys/time.h>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+/*
+ * Directory of analysis results, one file per key named by the MD5 of the key and a salt identifying the analysis.
+ *
+ * Several processes may share the directory: an entry is written to a unique temporary file and renamed into
+ * place, so readers see either no entry or a complete one. A hit touches the entry, and trim() removes the
+ * least recently used entries until the directory is back under its size budget. Any file system error only
+ * makes a lookup miss or a store get lost.
+ */
+class ResultCache {
+public:
+    ResultCache(std::string dir, uint64_t maxBytes, std::string salt)
+            : dir(std::move(dir)), maxBytes(maxBytes), salt(std::move(salt)) {
+        llvm::sys::fs::create_directories(this->dir);
+    }
+
+    static std::string hash(llvm::StringRef data) {
+        llvm::MD5 md5;
+        md5.update(data);
+        llvm::MD5::MD5Result digest;
+        md5.final(digest);
+        return digest.digest().str().str();
+    }
+
+    [[nodiscard]] unsigned long long hits() const { return numHits; }
+    [[nodiscard]] unsigned long long misses() const { return numMisses; }
+
+    bool lookup(llvm::StringRef key, std::string &result) {
+        std::string path = entryPath(key);
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        if (!buffer) {
+            ++numMisses;
+            return false;
+        }
+        result = (*buffer)->getBuffer().str();
+        // the modification time is the last use
+        utimes(path.c_str(), nullptr);
+        ++numHits;
+        return true;
+    }
+
+    void store(llvm::StringRef key, llvm::StringRef result) {
+        std::string path = entryPath(key);
+        llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path));
+
+        int FD;
+        llvm::SmallString<128> tmp;
+        if (llvm::sys::fs::createUniqueFile(path + ".tmp-%%%%%%%%", FD, tmp))
+            return;
+        {
+            llvm::raw_fd_ostream out(FD, true);
+            out << result;
+            out.close();
+            if (out.has_error()) {
+                out.clear_error();
+                llvm::sys::fs::remove(tmp);
+                return;
+            }
+        }
+        if (llvm::sys::fs::rename(tmp, path))
+            llvm::sys::fs::remove(tmp);
+    }
+
+    // remove the least recently used entries until the cache takes at most 90% of its budget
+    void trim() {
+        std::vector<std::tuple<llvm::sys::TimePoint<>, uint64_t, std::string>> entries;
+        uint64_t total = 0;
+        std::error_code EC;
+        for (llvm::sys::fs::recursive_directory_iterator it(dir, EC), end; it != end && !EC; it.increment(EC)) {
+            auto status = it->status();
+            if (!status || status->type() != llvm::sys::fs::file_type::regular_file)
+                continue;
+            total += status->getSize();
+            entries.emplace_back(status->getLastModificationTime(), status->getSize(), it->path());
+        }
+        if (total <= maxBytes)
+            return;
+
+        std::sort(entries.begin(), entries.end());
+        for (const auto &[time, size, path]: entries) {
+            if (total <= maxBytes / 10 * 9)
+                break;
+            // another process may have removed it already
+            llvm::sys::fs::remove(path);
+            total -= size;
+        }
+    }
+
+private:
+    std::string dir;
+    uint64_t maxBytes;
+    std::string salt;
+    std::atomic<unsigned long long> numHits{0}, numMisses{0};
+
+    std::string entryPath(llvm::StringRef key) const {
+        std::string hex = hash(salt + key.str());
+        // two levels keep directories small
+        llvm::SmallString<128> path(dir);
+        llvm::sys::path::append(path, hex.substr(0, 2), hex.substr(2));
+        return path.str().str();
+    }
+};
+
+#endif //COMMON_RESULTCACHE_H
@@ -0,0 +1,324 @@
+#ifndef COMMON_RESULTWRITER_H
+#define COMMON_RESULTWRITER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+/*
+ * Machine readable results. A result is a stream of flat records: a kind and a list of named fields, each an
+ * integer or a string. Records give the context of those after them rather than being repeated in each, e.g.
+ *     {"kind":"block","name":"while.cond"}
+ *     {"kind":"sep","x":"i","y":"j","sep":10}
+ * is the sep of i and j at while.cond. The driver starts the records of every function with a "function"
+ * record, and those of every file with a "file" record in batch mode.
+ *
+ * JSON Lines writes a record per line. The binary format writes a record as its length in bytes followed by
+ * its content, all integers as LEB128 varints (signed ones zigzag encoded first):
+ *     record  := length kind count (name value)*, a record of length 0 forgets every string seen before
+ *     value   := 0 zigzag-int | 1 string
+ *     string  := id of a string seen before (from 1) | 0 length bytes, the next id
+ * A writer starts with an empty record, so the output of every function can be decoded on its own.
+ *
+ * A single ResultWriter writes both, all inline so the loops writing records compile down to stores into its
+ * buffer, which is handed to the stream every few KB. Values are formatted in place, no string is built per value.
+ */
+enum class OutputFormat { Text, JsonLines, Binary };
+
+class ResultWriter {
+public:
+    // `format` is JsonLines or Binary
+    ResultWriter(llvm::raw_ostream &OS, OutputFormat format): OS(OS), binary(format == OutputFormat::Binary) {
+        if (binary)
+            buffer[used++] = 0;
+    }
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+    ~ResultWriter() { flush(); }
+
+    void begin(llvm::StringRef kind) {
+        char *p = reserve(2 * MAX_VARINT + 16 + 6 * kind.size());
+        if (binary) {
+            // a byte is kept for the length and one for the count, almost always enough
+            start = used;
+            *p++ = 0;
+            p = string(p, kind);
+            countAt = p - buffer.data();
+            *p++ = 0;
+            fields = 0;
+        } else {
+            p = append(p, "{\"kind\":");
+            p = jsonString(p, kind);
+        }
+        used = p - buffer.data();
+    }
+
+    void field(llvm::StringRef name, long long value) {
+        char *p = reserve(2 * MAX_VARINT + 32 + 6 * name.size());
+        if (binary) {
+            p = string(p, name);
+            *p++ = 0;
+            p = varint(p, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+            ++fields;
+        } else {
+            p = jsonKey(p, name);
+            // digits backwards, the most negative value has no positive counterpart
+            char digits[20];
+            unsigned n = 0;
+            unsigned long long magnitude = value < 0 ? 0 - static_cast<unsigned long long>(value) : value;
+            do {
+                digits[n++] = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude);
+            if (value < 0)
+                *p++ = '-';
+            while (n)
+                *p++ = digits[--n];
+        }
+        used = p - buffer.data();
+    }
+
+    void field(llvm::StringRef name, llvm::StringRef value) {
+        char *p = reserve(3 * MAX_VARINT + 16 + 6 * (name.size() + value.size()));
+        if (binary) {
+            p = string(p, name);
+            *p++ = 1;
+            p = string(p, value);
+            ++fields;
+        } else {
+            p = jsonKey(p, name);
+            p = jsonString(p, value);
+        }
+        used = p - buffer.data();
+    }
+
+    void end() {
+        if (binary) {
+            patch(countAt, fields);
+            patch(start, used - start - 1);
+        } else {
+            char *p = reserve(2);
+            p[0] = '}';
+            p[1] = '\n';
+            used += 2;
+        }
+        if (used >= FLUSH_SIZE)
+            flush();
+    }
+
+    // a record with a single field
+    template <typename T>
+    void record(llvm::StringRef kind, llvm::StringRef name, const T &value) {
+        begin(kind);
+        field(name, value);
+        end();
+    }
+
+    // hand the records written so far to the stream, also done every FLUSH_SIZE bytes and on destruction
+    void flush() {
+        OS.write(buffer.data(), used);
+        used = 0;
+    }
+
+private:
+    static constexpr size_t FLUSH_SIZE = 16 << 10;
+    static constexpr size_t MAX_VARINT = 10;
+    static constexpr size_t RECENT = 1024;
+
+    // the string last written from an address, checked before the map: names and field names are written again
+    // and again from the same few places
+    struct Recent {
+        const char *data = nullptr;
+        const llvm::StringMapEntry<unsigned> *entry = nullptr;
+    };
+
+    llvm::raw_ostream &OS;
+    bool binary;
+    // records not flushed yet, written through raw pointers after making room for a whole field
+    std::vector<char> buffer = std::vector<char>(2 * FLUSH_SIZE);
+    size_t used = 0;
+    // the binary record being written
+    size_t start = 0, countAt = 0;
+    unsigned fields = 0;
+    llvm::StringMap<unsigned> ids;
+    Recent recent[RECENT];
+
+    // room for `size` more bytes, the buffer only grows for huge fields
+    char *reserve(size_t size) {
+        if (used + size > buffer.size())
+            buffer.resize(std::max(2 * buffer.size(), used + size));
+        return buffer.data() + used;
+    }
+
+    static char *append(char *p, llvm::StringRef str) {
+        std::copy(str.begin(), str.end(), p);
+        return p + str.size();
+    }
+
+    static char *varint(char *p, uint64_t value) {
+        do {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            *p++ = static_cast<char>(value ? byte | 0x80 : byte);
+        } while (value);
+        return p;
+    }
+
+    // write `value` to the byte kept at `at`, making room for the rest of a longer varint
+    void patch(size_t at, uint64_t value) {
+        if (value < 0x80) {
+            buffer[at] = static_cast<char>(value);
+            return;
+        }
+        char bytes[MAX_VARINT];
+        size_t size = varint(bytes, value) - bytes;
+        reserve(size - 1);
+        std::copy_backward(buffer.begin() + at + 1, buffer.begin() + used, buffer.begin() + used + size - 1);
+        std::copy(bytes, bytes + size, buffer.begin() + at);
+        used += size - 1;
+    }
+
+    // the id of a string written before, or the string itself; room for its bytes is already made
+    char *string(char *p, llvm::StringRef str) {
+        auto address = reinterpret_cast<uintptr_t>(str.data());
+        Recent &last = recent[(address ^ address >> 10 ^ str.size()) % RECENT];
+        if (last.data == str.data() && last.entry->getKeyLength() == str.size() && same(last.entry->getKeyData(), str))
+            return varint(p, last.entry->second);
+        auto [it, added] = ids.try_emplace(str, ids.size() + 1);
+        last = {str.data(), &*it};
+        if (!added)
+            return varint(p, it->second);
+        p = varint(p, 0);
+        p = varint(p, str.size());
+        return append(p, str);
+    }
+
+    // the names written are short, a call to memcmp would cost more than the loop
+    static bool same(const char *data, llvm::StringRef str) {
+        for (char c: str)
+            if (*data++ != c)
+                return false;
+        return true;
+    }
+
+    static char *jsonKey(char *p, llvm::StringRef name) {
+        *p++ = ',';
+        p = jsonString(p, name);
+        *p++ = ':';
+        return p;
+    }
+
+    static char *jsonString(char *p, llvm::StringRef str) {
+        static const char hex[] = "0123456789abcdef";
+        *p++ = '"';
+        for (char c: str) {
+            if (c == '"' || c == '\\') {
+                *p++ = '\\';
+                *p++ = c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                p = append(p, "\\u00");
+                *p++ = hex[(c >> 4) & 0xf];
+                *p++ = hex[c & 0xf];
+            } else {
+                *p++ = c;
+            }
+        }
+        *p++ = '"';
+        return p;
+    }
+};
+
+/*
+ * Decodes the binary format, one record at a time.
+ */
+class BinaryReader {
+public:
+    struct Value {
+        bool isString = false;
+        long long number = 0;
+        std::string string;
+    };
+    struct Record {
+        std::string kind;
+        std::vector<std::pair<std::string, Value>> fields;
+    };
+
+    explicit BinaryReader(llvm::StringRef data): data(data) {}
+
+    // false at the end of the data, or if it is malformed
+    bool next(Record &record) {
+        while (pos < data.size()) {
+            uint64_t length;
+            if (!varint(length) || length > data.size() - pos)
+                return false;
+            if (length == 0) {
+                strings.clear();
+                continue;
+            }
+            size_t end = pos + length;
+            uint64_t count;
+            record.fields.clear();
+            if (!string(record.kind) || !varint(count))
+                return false;
+            for (uint64_t i = 0; i < count; ++i) {
+                std::pair<std::string, Value> field;
+                if (!string(field.first) || pos >= end)
+                    return false;
+                field.second.isString = data[pos++] == 1;
+                uint64_t number;
+                if (field.second.isString ? !string(field.second.string) : !varint(number))
+                    return false;
+                if (!field.second.isString)
+                    field.second.number = static_cast<long long>((number >> 1) ^ -(number & 1));
+                record.fields.push_back(std::move(field));
+            }
+            if (pos != end)
+                return false;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    llvm::StringRef data;
+    size_t pos = 0;
+    std::vector<std::string> strings;
+
+    bool varint(uint64_t &value) {
+        value = 0;
+        for (unsigned shift = 0; pos < data.size() && shift < 64; shift += 7) {
+            uint8_t byte = data[pos++];
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+    bool string(std::string &str) {
+        uint64_t id, length;
+        if (!varint(id))
+            return false;
+        if (id) {
+            if (id > strings.size())
+                return false;
+            str = strings[id - 1];
+            return true;
+        }
+        if (!varint(length) || length > data.size() - pos)
+            return false;
+        str = data.substr(pos, length).str();
+        pos += length;
+        strings.push_back(str);
+        return true;
+    }
+};
+
+#endif //COMMON_RESULTWRITER_H
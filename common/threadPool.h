@@ -0,0 +1,144 @@
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed size work-stealing thread pool. Every worker owns a deque of tasks: it takes its own tasks
+ * from the back and, when it has none left, steals from the front of the other workers' deques.
+ * Tasks submitted from outside the pool are dealt round robin, tasks submitted by a worker go to its own deque.
+ */
+class ThreadPool {
+public:
+    typedef std::function<void()> task_fn;
+
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency()) {
+        threads = std::max(1u, threads);
+        for (unsigned i = 0; i < threads; ++i)
+            queues.push_back(std::make_unique<TaskQueue>());
+        for (unsigned i = 0; i < threads; ++i)
+            workers.emplace_back(&ThreadPool::work, this, i);
+    }
+
+    ~ThreadPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker: workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    [[nodiscard]] unsigned size() const { return workers.size(); }
+
+    void submit(task_fn task) {
+        unsigned target = self() >= 0 ? self() : next++ % queues.size();
+        {
+            // counted before it is visible, so a worker taking it right away never sees the counters go below zero
+            std::lock_guard<std::mutex> guard(lock);
+            ++pending;
+            ++queued;
+        }
+        {
+            std::lock_guard<std::mutex> guard(queues[target]->lock);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    // block until every submitted task has finished
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this] { return pending == 0; });
+    }
+
+private:
+    struct TaskQueue {
+        std::mutex lock;
+        std::deque<task_fn> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex lock; // guards the counters below
+    std::condition_variable wake, done;
+    size_t pending = 0; // submitted but not finished
+    size_t queued = 0;  // submitted but not started
+    bool stopping = false;
+    std::atomic<unsigned> next{0};
+
+    struct WorkerId {
+        const ThreadPool *pool = nullptr;
+        int index = -1;
+    };
+
+    static WorkerId &current() {
+        static thread_local WorkerId id;
+        return id;
+    }
+
+    // index of the worker of this pool running on this thread, -1 outside the pool
+    int self() const {
+        return current().pool == this ? current().index : -1;
+    }
+
+    bool take(unsigned index, task_fn &task) {
+        // own tasks from the back, the most recently submitted first
+        {
+            std::lock_guard<std::mutex> guard(queues[index]->lock);
+            if (!queues[index]->tasks.empty()) {
+                task = std::move(queues[index]->tasks.back());
+                queues[index]->tasks.pop_back();
+                return true;
+            }
+        }
+        // steal the oldest task of another worker
+        for (unsigned i = 1; i < queues.size(); ++i) {
+            TaskQueue &victim = *queues[(index + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(unsigned index) {
+        current() = {this, int(index)};
+        while (true) {
+            task_fn task;
+            if (take(index, task)) {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    --queued;
+                }
+                task();
+                std::lock_guard<std::mutex> guard(lock);
+                if (--pending == 0)
+                    done.notify_all();
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0)
+                return;
+        }
+    }
+};
+
+#endif //COMMON_THREADPOOL_H